@@ -0,0 +1,287 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import ErrorHandling;
+
+using namespace cppline::errors;
+using benchmark::State;
+
+namespace {
+
+void context_construct(State& state)
+{
+    for (auto _ : state) {
+        auto context = Context{ Param::OptionName, "--option" } <<
+            Context{ Param::ExpectedArgumentCount, "2" } <<
+            Context{ Param::ReceivedArgumentCount, "1" };
+        benchmark::DoNotOptimize(context);
+    }
+}
+
+void context_enums(State& state)
+{
+    for (auto _ : state) {
+        auto context = Context{} << Status::ParsingError << Message::ExpectedKeyAndValue;
+        benchmark::DoNotOptimize(context);
+    }
+}
+
+void context_merge(State& state)
+{
+    const auto location = Context{ Param::SourceFile, "Parser.cpp" } << Context{ Param::SourceLine, "42" };
+    const auto error = Context{ Param::OptionName, "--option" } << Status::InvalidValue;
+    for (auto _ : state) {
+        auto merged = location;
+        merged << error;
+        benchmark::DoNotOptimize(merged);
+    }
+}
+
+// The map based layout Context used before it moved to inline, enum indexed slots
+struct MapContext {
+    std::unordered_map<Param, std::string> string_context;
+    std::map<EnumTypes, uint32_t> enum_context;
+
+    MapContext& operator<<(const MapContext& other)
+    {
+        string_context.insert(other.string_context.begin(), other.string_context.end());
+        enum_context.insert(other.enum_context.begin(), other.enum_context.end());
+        return *this;
+    }
+};
+
+// Builds and merges the contexts of a typical parsing error, like Parser::parse_non_positional does
+void context_parsing_error(State& state)
+{
+    for (auto _ : state) {
+        auto context = Context{ Param::OptionName, "--option" } <<
+            Context{ Param::ExpectedArgumentCount, "2" } <<
+            Context{ Param::ReceivedArgumentCount, "1" };
+        benchmark::DoNotOptimize(Context(Status::NotEnoughArguments) << context);
+    }
+}
+
+void context_parsing_error_with_maps(State& state)
+{
+    for (auto _ : state) {
+        MapContext context;
+        context << MapContext{ { { Param::OptionName, "--option" } }, {} }
+            << MapContext{ { { Param::ExpectedArgumentCount, "2" } }, {} }
+            << MapContext{ { { Param::ReceivedArgumentCount, "1" } }, {} };
+        MapContext error{ {}, { { EnumTypes::Status, static_cast<uint32_t>(Status::NotEnoughArguments) } } };
+        benchmark::DoNotOptimize(error << context);
+    }
+}
+
+void exception_construct(State& state)
+{
+    const auto context = Context{ Param::OptionName, "--option" };
+    for (auto _ : state) {
+        Exception exception(Status::ParsingError, context, std::source_location::current(), std::nullopt);
+        benchmark::DoNotOptimize(exception);
+    }
+}
+
+void exception_construct_with_stacktrace(State& state)
+{
+    const auto context = Context{ Param::OptionName, "--option" };
+    for (auto _ : state) {
+        Exception exception(Status::ParsingError, context, std::source_location::current(), std::stacktrace::current());
+        benchmark::DoNotOptimize(exception);
+    }
+}
+
+void exception_get_context(State& state)
+{
+    const auto context = Context{ Param::OptionName, "--option" };
+    for (auto _ : state) {
+        const Exception exception(Status::ParsingError, context, std::source_location::current(), std::nullopt);
+        benchmark::DoNotOptimize(&exception.get_context());
+    }
+}
+
+void error_construct(State& state)
+{
+    for (auto _ : state) {
+        Error error(Status::ParsingError, {}, std::source_location::current(), std::nullopt);
+        benchmark::DoNotOptimize(error);
+    }
+}
+
+ExpectedVoid failing_function()
+{
+    return make_unexpected(Status::ParsingError, Context{ Param::ErrorMessage, "message" });
+}
+
+void stacktrace_policy_off() { StacktracePolicy::set_off(); }
+void stacktrace_policy_always() { StacktracePolicy::set_always(); }
+void stacktrace_policy_not_listed() { StacktracePolicy::set_status_allow_list({ Status::UnknownError }); }
+void stacktrace_policy_sampling() { StacktracePolicy::set_sampling(100); }
+void stacktrace_policy_rate_limit() { StacktracePolicy::set_rate_limit(10, std::chrono::seconds(1)); }
+
+// Sad path cost under a stacktrace policy, the policy goes back to the build default afterwards
+void error_with_stacktrace_policy(State& state, void (*apply_policy)())
+{
+    apply_policy();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(failing_function());
+    }
+    if constexpr (CONSTEXPR_IS_DEBUG) {
+        StacktracePolicy::set_always();
+    }
+    else {
+        StacktracePolicy::set_off();
+    }
+}
+
+// Symbolizing every frame of the trace, the frame cache is cleared outside the timing
+void stacktrace_format_cold(State& state)
+{
+    const auto stacktrace = std::stacktrace::current();
+    for (auto _ : state) {
+        state.PauseTiming();
+        StacktraceFormatter::clear_cache();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(StacktraceFormatter::format(stacktrace));
+    }
+}
+
+void stacktrace_format_cached(State& state)
+{
+    const auto stacktrace = std::stacktrace::current();
+    StacktraceFormatter::format(stacktrace);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StacktraceFormatter::format(stacktrace));
+    }
+}
+
+// Before the name tables every lookup returned a new std::string
+void enum_name_as_string(State& state)
+{
+    constexpr auto status_count = static_cast<uint32_t>(Status::FileError) + 1;
+    uint32_t status = 0;
+    for (auto _ : state) {
+        auto name = std::string(enum_to_string(EnumTypes::Status, status));
+        benchmark::DoNotOptimize(name);
+        status = (status + 1) % status_count;
+    }
+}
+
+void enum_name_from_table(State& state)
+{
+    constexpr auto status_count = static_cast<uint32_t>(Status::FileError) + 1;
+    uint32_t status = 0;
+    for (auto _ : state) {
+        auto name = enum_to_string(EnumTypes::Status, status);
+        benchmark::DoNotOptimize(name);
+        status = (status + 1) % status_count;
+    }
+}
+
+// Formats into a NullSink, so only building and formatting records is measured
+template <LogEncoding Encoding>
+void logger_format(State& state)
+{
+    const auto context = Context{ Param::OptionName, "--option" } << Context{ Param::ArgumentValue, "value" } << Status::InvalidValue;
+    Logger::set_sink(std::make_shared<NullSink>());
+    Logger::set_encoding(Encoding);
+    for (auto _ : state) {
+        Logger::log("Parsing error", context);
+    }
+    Logger::set_encoding(LogEncoding::Text);
+    Logger::set_sink(nullptr);
+}
+
+void logger_format_exception(State& state)
+{
+    const Exception exception(Status::ParsingError, Context{ Param::OptionName, "--option" },
+                              std::source_location::current(), std::nullopt);
+    Logger::set_sink(std::make_shared<NullSink>());
+    for (auto _ : state) {
+        Logger::log("Parsing error", exception);
+    }
+    Logger::set_sink(nullptr);
+}
+
+void logger_disabled_level(State& state)
+{
+    const auto context = Context{ Param::OptionName, "--option" };
+    for (auto _ : state) {
+        Logger::log(LogLevel::Trace, "Parsing error", context);
+    }
+}
+
+std::filesystem::path benchmark_log_path(const std::string_view name)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "cppline-benchmarks";
+    std::filesystem::create_directories(directory);
+    return directory / name;
+}
+
+std::shared_ptr<LogSink> make_null_sink() { return std::make_shared<NullSink>(); }
+std::shared_ptr<LogSink> make_ring_buffer_sink() { return std::make_shared<RingBufferSink>(1024 * 1024); }
+std::shared_ptr<LogSink> make_buffered_file_sink() { return BufferedFileSink::open(benchmark_log_path("buffered.log")); }
+std::shared_ptr<LogSink> make_mapped_file_sink() { return MemoryMappedFileSink::open(benchmark_log_path("mapped.log")); }
+
+// Formatting plus writing through a sink, whatever a sink still buffers is flushed after the timing
+void logger_sink(State& state, std::shared_ptr<LogSink> (*make_sink)())
+{
+    const auto context = Context{ Param::OptionName, "--option" };
+    Logger::set_sink(make_sink());
+    for (auto _ : state) {
+        Logger::log("Parsing error", context);
+    }
+    Logger::set_sink(nullptr);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Time the callers spend logging from several threads at once. The asynchronous logger moves the
+// formatting off their threads, the records still queued are written when it stops.
+void logger_from_threads(State& state, const bool async)
+{
+    const auto context = Context{ Param::OptionName, "--option" } << Context{ Param::Index, "1" };
+    if (state.thread_index() == 0) {
+        Logger::set_sink(std::make_shared<NullSink>());
+        if (async) {
+            Logger::start_async({ .capacity = 4096, .overflow = OverflowPolicy::Block });
+        }
+    }
+    for (auto _ : state) {
+        Logger::log("Parsing error", context);
+    }
+    if (state.thread_index() == 0) {
+        Logger::stop_async();
+        Logger::set_sink(nullptr);
+    }
+}
+
+BENCHMARK(context_construct)->Name("Context/Construct");
+BENCHMARK(context_enums)->Name("Context/Enums");
+BENCHMARK(context_merge)->Name("Context/Merge");
+BENCHMARK(context_parsing_error)->Name("Context/ParsingError");
+BENCHMARK(context_parsing_error_with_maps)->Name("Context/ParsingErrorWithMaps");
+BENCHMARK(exception_construct)->Name("Exception/Construct");
+BENCHMARK(exception_construct_with_stacktrace)->Name("Exception/ConstructWithStacktrace");
+BENCHMARK(exception_get_context)->Name("Exception/GetContext");
+BENCHMARK(error_construct)->Name("Error/Construct");
+BENCHMARK_CAPTURE(error_with_stacktrace_policy, off, stacktrace_policy_off)->Name("Error/StacktracePolicy/Off");
+BENCHMARK_CAPTURE(error_with_stacktrace_policy, always, stacktrace_policy_always)->Name("Error/StacktracePolicy/Always");
+BENCHMARK_CAPTURE(error_with_stacktrace_policy, not_listed, stacktrace_policy_not_listed)->Name("Error/StacktracePolicy/StatusNotListed");
+BENCHMARK_CAPTURE(error_with_stacktrace_policy, sampling, stacktrace_policy_sampling)->Name("Error/StacktracePolicy/Sampling100");
+BENCHMARK_CAPTURE(error_with_stacktrace_policy, rate_limit, stacktrace_policy_rate_limit)->Name("Error/StacktracePolicy/RateLimit10PerSecond");
+BENCHMARK(stacktrace_format_cold)->Name("Stacktrace/Format/Cold");
+BENCHMARK(stacktrace_format_cached)->Name("Stacktrace/Format/Cached");
+BENCHMARK(enum_name_as_string)->Name("Enum/NameAsString");
+BENCHMARK(enum_name_from_table)->Name("Enum/NameFromTable");
+BENCHMARK(logger_format<LogEncoding::Text>)->Name("Logger/FormatText");
+BENCHMARK(logger_format<LogEncoding::Binary>)->Name("Logger/FormatBinary");
+BENCHMARK(logger_format_exception)->Name("Logger/FormatException");
+BENCHMARK(logger_disabled_level)->Name("Logger/DisabledLevel");
+BENCHMARK_CAPTURE(logger_sink, null, make_null_sink)->Name("Logger/Sink/Null");
+BENCHMARK_CAPTURE(logger_sink, ring_buffer, make_ring_buffer_sink)->Name("Logger/Sink/RingBuffer");
+BENCHMARK_CAPTURE(logger_sink, buffered_file, make_buffered_file_sink)->Name("Logger/Sink/BufferedFile");
+BENCHMARK_CAPTURE(logger_sink, mapped_file, make_mapped_file_sink)->Name("Logger/Sink/MemoryMappedFile");
+BENCHMARK_CAPTURE(logger_from_threads, sync, false)->Name("Logger/Threads/Synchronous")->Threads(4)->UseRealTime();
+BENCHMARK_CAPTURE(logger_from_threads, async, true)->Name("Logger/Threads/Asynchronous")->Threads(4)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,6 @@
+// main.cpp
+// Microbenchmarks of the parser and the error handling paths, takes the Google Benchmark flags:
+//   CPPLineBenchmarks --benchmark_filter=Parser/ --benchmark_out=results.json
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
@@ -0,0 +1,227 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import CPPLine;
+import ErrorHandling;
+
+using namespace cppline;
+using namespace cppline::errors;
+using benchmark::State;
+
+namespace {
+
+std::vector<std::string> make_option_names(const std::int64_t option_count)
+{
+    std::vector<std::string> names;
+    for (std::int64_t index = 0; index < option_count; ++index) {
+        names.push_back(std::format("--option{}", index));
+    }
+    return names;
+}
+
+// Command line of state.range(0) tokens: a single flag, or pairs of int options and their values
+struct CommandLine {
+    std::vector<std::string> option_names;
+    std::vector<std::string> tokens;
+    std::vector<std::string_view> arguments;
+
+    explicit CommandLine(const std::int64_t token_count)
+    {
+        option_names = make_option_names(std::max<std::int64_t>(token_count / 2, 1));
+        if (token_count == 1) {
+            tokens.push_back(option_names.front());
+        }
+        else {
+            for (const auto& [index, name] : std::views::enumerate(option_names)) {
+                tokens.push_back(name);
+                tokens.push_back(std::to_string(index));
+            }
+        }
+        arguments.assign(tokens.begin(), tokens.end());
+    }
+
+    void register_options(Parser& parser) const
+    {
+        for (const auto& name : option_names) {
+            if (tokens.size() == 1) {
+                parser.add_bool(name, "Generated flag");
+            }
+            else {
+                parser.add_int(name, "Generated option");
+            }
+        }
+    }
+};
+
+void parser_register(State& state)
+{
+    const auto names = make_option_names(state.range(0));
+    for (auto _ : state) {
+        Parser parser("Benchmark Parser");
+        for (const auto& name : names) {
+            parser.add_int(name, "Generated option", 1);
+        }
+        parser.freeze();
+        benchmark::DoNotOptimize(parser);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A Parser accepts one command line, so each iteration builds a new one outside of the measurement
+void parser_parse(State& state)
+{
+    const CommandLine command_line(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        Parser parser("Benchmark Parser");
+        command_line.register_options(parser);
+        parser.freeze();
+        state.ResumeTiming();
+
+        const auto result = parser.try_parse(command_line.arguments);
+        if (!result.has_value()) {
+            state.SkipWithError(std::format("parse failed with {}", enum_name(result.error().get_error())).c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void parser_custom_option(State& state)
+{
+    const std::vector<std::string_view> arguments{ "--keyvalue", "key", "value" };
+    for (auto _ : state) {
+        state.PauseTiming();
+        Parser parser("Benchmark Parser");
+        parser.add_option("--keyvalue", "Set a key-value pair",
+                          [](const std::span<const std::string_view> args) -> std::any {
+                              return std::make_pair(std::string(args[0]), std::string(args[1]));
+                          },
+                          2);
+        state.ResumeTiming();
+
+        if (!parser.try_parse(arguments).has_value()) {
+            state.SkipWithError("parse failed");
+            break;
+        }
+        benchmark::DoNotOptimize(parser.try_get<std::pair<std::string, std::string>>("--keyvalue"));
+    }
+}
+
+struct ParsedOptions {
+    std::vector<std::string> names = make_option_names(100);
+    Parser parser{ "Benchmark Parser" };
+
+    ParsedOptions()
+    {
+        for (const auto& name : names) {
+            parser.add_int(name, "Generated option", 1);
+        }
+        parser.freeze();
+    }
+};
+
+void parser_try_get(State& state)
+{
+    const ParsedOptions options;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(options.parser.try_get<int>(options.names[index++ % options.names.size()]));
+    }
+}
+
+void parser_try_get_wrong_type(State& state)
+{
+    const ParsedOptions options;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(options.parser.try_get<std::string>(options.names.front()));
+    }
+}
+
+// How try_get reported a type mismatch before values were typed: std::any_cast by value and bad_any_cast
+void any_cast_wrong_type_throws(State& state)
+{
+    const std::any value = 1;
+    for (auto _ : state) {
+        try {
+            benchmark::DoNotOptimize(std::any_cast<std::string>(value));
+        }
+        catch (const std::bad_any_cast& exception) {
+            benchmark::DoNotOptimize(&exception);
+        }
+    }
+}
+
+// Lookups by name of state.range(0) options, through the option map or through the table freeze builds
+void parser_lookup(State& state, const bool frozen)
+{
+    const auto names = make_option_names(state.range(0));
+    Parser parser("Benchmark Parser");
+    for (const auto& name : names) {
+        parser.add_int(name, "Generated option", 1);
+    }
+    if (frozen) {
+        parser.freeze();
+        if (!parser.is_frozen()) {
+            state.SkipWithError("no collision-free table for the option names");
+            return;
+        }
+    }
+
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.try_get<int>(names[index++ % names.size()]));
+    }
+}
+
+void parser_get(State& state)
+{
+    const ParsedOptions options;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(options.parser.get<int>(options.names[index++ % options.names.size()]));
+    }
+}
+
+// The std::stoi based conversion the built-in int options used before parse_number
+Expected<int> parse_int_with_stoi(const std::string_view argument)
+{
+    try {
+        return std::stoi(std::string(argument));
+    }
+    catch (const std::exception& exception) {
+        return make_unexpected(Status::InvalidValue,
+                               Context{ Param::ArgumentValue, argument } <<
+                               Context{ Param::ErrorMessage, exception.what() });
+    }
+}
+
+void number_stoi(State& state, const std::string_view input)
+{
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse_int_with_stoi(input));
+    }
+}
+
+void number_from_chars(State& state, const std::string_view input)
+{
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parse_number<int>(input));
+    }
+}
+
+BENCHMARK(parser_register)->Name("Parser/Register")->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(parser_parse)->Name("Parser/Parse")->Arg(1)->Arg(10)->Arg(100)->Arg(10'000);
+BENCHMARK(parser_custom_option)->Name("Parser/CustomOption");
+BENCHMARK(parser_try_get)->Name("Parser/TryGet");
+BENCHMARK(parser_try_get_wrong_type)->Name("Parser/TryGetWrongType");
+BENCHMARK(any_cast_wrong_type_throws)->Name("Parser/AnyCastWrongTypeThrows");
+BENCHMARK(parser_get)->Name("Parser/Get");
+BENCHMARK_CAPTURE(parser_lookup, map, false)->Name("Parser/Lookup/Map")->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(parser_lookup, frozen, true)->Name("Parser/Lookup/Frozen")->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK_CAPTURE(number_stoi, valid, std::string_view("123456789"))->Name("Number/Stoi/Valid");
+BENCHMARK_CAPTURE(number_stoi, invalid, std::string_view("not a number"))->Name("Number/Stoi/Invalid");
+BENCHMARK_CAPTURE(number_from_chars, valid, std::string_view("123456789"))->Name("Number/FromChars/Valid");
+BENCHMARK_CAPTURE(number_from_chars, invalid, std::string_view("not a number"))->Name("Number/FromChars/Invalid");
+
+} // namespace
@@ -0,0 +1,23 @@
+//
+// AllocationCounter.h
+//
+// The test executable replaces the global operator new (see AllocationCounter.cpp),
+// so tests can count the heap allocations made by a block of code.
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace allocation_counter {
+
+std::size_t count();
+
+template <typename Callable>
+std::size_t count_allocations(Callable&& func) {
+    const std::size_t before = count();
+    func();
+    return count() - before;
+}
+
+} // namespace allocation_counter
@@ -0,0 +1,209 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.h"
+
+import CPPLine;
+
+import std;
+
+using namespace cppline::errors;
+
+namespace {
+
+struct GeneratedArguments {
+    std::string description = "Arena Parser";
+    std::string help = "Generated option";
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+    std::vector<std::string_view> args;
+};
+
+GeneratedArguments make_arguments(const int option_count) {
+    GeneratedArguments generated;
+    for (int i = 0; i < option_count; ++i) {
+        generated.names.push_back(std::format("--opt{}", i));
+        generated.values.push_back(std::to_string(i));
+    }
+    for (int i = 0; i < option_count; ++i) {
+        generated.args.push_back(generated.names[i]);
+        generated.args.push_back(generated.values[i]);
+    }
+    return generated;
+}
+
+// Registers and parses the generated int options inside an arena, returns the number of heap allocations.
+// All strings are built up front, so only allocations made by the parser itself are counted.
+std::size_t register_and_parse_in_arena(const GeneratedArguments& generated) {
+    static std::array<std::byte, 256 * 1024> buffer;
+
+    return allocation_counter::count_allocations([&]() {
+        // A null upstream makes an arena overflow fail loudly instead of quietly using the heap
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+        cppline::Parser parser(generated.description, &arena);
+        for (const auto& name : generated.names) {
+            parser.add_int(name, generated.help);
+        }
+
+        parser.parse(generated.args);
+        EXPECT_EQ(parser.get<int>(generated.names.back()), static_cast<int>(generated.names.size()) - 1);
+    });
+}
+
+} // namespace
+
+TEST(AllocationTest, ArenaParserAllocationsDoNotGrowWithOptionCount) {
+    const auto few = make_arguments(5);
+    const auto many = make_arguments(50);
+
+    const std::size_t few_allocations = register_and_parse_in_arena(few);
+    const std::size_t many_allocations = register_and_parse_in_arena(many);
+
+    std::cout << std::format("Heap allocations with an arena: 5 options {}, 50 options {}\n",
+                             few_allocations, many_allocations);
+
+    EXPECT_EQ(few_allocations, many_allocations);
+    EXPECT_LE(many_allocations, 2u);
+}
+
+TEST(AllocationTest, RegistrationMovesParseFunctionAndDefaultValue) {
+    static std::array<std::byte, 16 * 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    cppline::Parser parser("Arena Parser", &arena);
+
+    // Long enough that every copy of the capture or of the default value allocates
+    cppline::ParseFunctionType parse_function =
+        [suffix = std::string(64, 's')](std::span<const std::string_view> args) -> Expected<std::any> {
+            return std::string(args[0]) + suffix;
+        };
+    std::any default_value = std::string(64, 'd');
+    const std::string name = "--custom";
+    const std::string help = "Custom option with a long help text that would not fit any small string buffer";
+
+    const std::size_t allocations = allocation_counter::count_allocations([&]() {
+        parser.add_option(name, help, std::move(parse_function), 1, std::move(default_value));
+    });
+
+    EXPECT_EQ(allocations, 0u) << "Registration should move the parse function and default value, not copy them.";
+    EXPECT_EQ(parser.get<std::string>("--custom"), std::string(64, 'd'));
+
+    const std::vector<std::string_view> args{ "--custom", "value" };
+    parser.parse(args);
+    EXPECT_EQ(parser.get<std::string>("--custom"), "value" + std::string(64, 's'));
+}
+
+namespace {
+
+// Heap allocations made while a missing option error bubbles out of parse or try_parse.
+// With a captured stacktrace every deep copy of the error allocates: copying an Error allocates its
+// Exception, copying an Exception allocates its stacktrace.
+std::size_t count_error_allocations(const bool throwing) {
+    cppline::Parser parser("Test Parser");
+    parser.add_int("--number", "Number option");
+    const std::vector<std::string_view> args{ "--missing" };
+
+    return allocation_counter::count_allocations([&]() {
+        if (throwing) {
+            try {
+                parser.parse(args);
+            }
+            catch (const Exception& exception) {
+                EXPECT_EQ(exception.get_error(), Status::OptionNotFound);
+            }
+        }
+        else {
+            const auto result = parser.try_parse(args);
+            EXPECT_EQ(result.error().get_error(), Status::OptionNotFound);
+        }
+    });
+}
+
+} // namespace
+
+TEST(AllocationTest, ErrorIsMovedNotCopiedWhenPropagated) {
+    StacktracePolicy::set_always();
+
+    const std::size_t returned = count_error_allocations(false);
+    const std::size_t thrown = count_error_allocations(true);
+
+    // A deliberate copy, to show the counting catches one
+    const Error error(Status::OptionNotFound, Context{ Param::OptionName, "--missing" });
+    const std::size_t copied = allocation_counter::count_allocations([&]() {
+        const Error copy = error;
+    });
+
+    if constexpr (CONSTEXPR_IS_DEBUG) {
+        StacktracePolicy::set_always();
+    }
+    else {
+        StacktracePolicy::set_off();
+    }
+
+    std::cout << std::format("Allocations: error returned {}, thrown {}, one copy {}\n", returned, thrown, copied);
+
+    EXPECT_GE(copied, 2u);
+    EXPECT_EQ(thrown, returned) << "parse should throw the error try_parse created without copying it.";
+}
+
+namespace {
+
+// Holds the background thread in its first write, so only the allocations of the logging thread are counted
+class GateSink final : public LogSink {
+public:
+    void write(const std::string_view text) override {
+        if (!m_entered.exchange(true)) {
+            m_entered.notify_all();
+            m_open.wait(false);
+        }
+        m_text += text;
+    }
+
+    void wait_until_entered() const { m_entered.wait(false); }
+    void open() {
+        m_open = true;
+        m_open.notify_all();
+    }
+    const std::string& text() const { return m_text; } // Only once the background thread is stopped
+
+private:
+    std::atomic<bool> m_entered = false;
+    std::atomic<bool> m_open = false;
+    std::string m_text;
+};
+
+} // namespace
+
+TEST(AllocationTest, AsyncLogSharesTheErrorContext) {
+    const std::string long_value(512, 'x'); // Past the inline buffer, so a copied context would allocate
+    const Exception exception(Status::InvalidValue, Context{ Param::ArgumentValue, long_value },
+                              std::source_location::current(), std::nullopt);
+    Error error(Exception(Status::ParsingError, Context{ Param::ArgumentValue, long_value },
+                          std::source_location::current(), std::nullopt));
+    exception.get_context(); // Merged up front, as by any earlier log or what()
+    error.get_cached_context();
+
+    auto sink = std::make_shared<GateSink>();
+    Logger::set_sink(sink);
+    Logger::start_async({ .capacity = 64, .overflow = OverflowPolicy::Block });
+    Logger::log("gate");
+    sink->wait_until_entered();
+
+    const std::size_t allocations = allocation_counter::count_allocations([&]() {
+        Logger::log("exception", exception);
+        Logger::log("error", error);
+        Logger::log("moved", std::move(error));
+    });
+
+    sink->open();
+    Logger::stop_async();
+    Logger::set_sink(nullptr);
+
+    EXPECT_EQ(allocations, 0u) << "Logging an Exception or Error should share its context, not copy it.";
+    size_t written = 0;
+    for (size_t position = sink->text().find(long_value); position != std::string::npos;
+         position = sink->text().find(long_value, position + long_value.size())) {
+        ++written;
+    }
+    EXPECT_EQ(written, 3u);
+}
@@ -1,6 +1,9 @@
 #include "pch.h"
 #include <gtest/gtest.h>
 
+#include "AllocationCounter.h"
+#include "../CPPLine/Macros.hpp"
+
 import CPPLine;
 
 import std;
@@ -133,7 +136,7 @@ TEST(ErrorsTest, ExpectedBetterOnSadFlow) {
     EXPECT_LT(avg_expected_time, avg_exception_time) << "Expected should perform better on the sad path.";
 }
 
-_declspec(noinline) void recursive_function_exception(volatile int& sink, bool should_throw, int number_of_calls) {
+CPPLINE_NOINLINE void recursive_function_exception(volatile int& sink, bool should_throw, int number_of_calls) {
     sink += 1;
     if (number_of_calls != 0) {
         recursive_function_exception(sink, should_throw, number_of_calls - 1);
@@ -147,7 +150,7 @@ _declspec(noinline) void recursive_function_exception(volatile int& sink, bool s
     }
 }
 
-_declspec(noinline) ExpectedVoid recursive_function_expected(volatile int& sink, bool should_fail, int number_of_calls) {
+CPPLINE_NOINLINE ExpectedVoid recursive_function_expected(volatile int& sink, bool should_fail, int number_of_calls) {
     if (number_of_calls != 0) {
         auto result = recursive_function_expected(sink, should_fail, number_of_calls - 1);
         if (!result.has_value()) {
@@ -263,3 +266,299 @@ TEST(ErrorsTest, NestedExpectedBetterOnSadFlow) {
 
     EXPECT_LT(avg_expected_time, avg_exception_time) << "Expected should perform better on the sad path with nesting.";
 }
+
+namespace {
+
+// The map based layout Context used before it moved to inline, enum indexed slots
+struct MapContext {
+    std::unordered_map<Param, std::string> string_context;
+    std::map<EnumTypes, uint32_t> enum_context;
+
+    MapContext& operator<<(const MapContext& other) {
+        string_context.insert(other.string_context.begin(), other.string_context.end());
+        enum_context.insert(other.enum_context.begin(), other.enum_context.end());
+        return *this;
+    }
+};
+
+// Builds and merges the contexts of a typical parsing error, like Parser::parse_non_positional does
+Context make_parsing_error_context(const std::string_view option_name) {
+    auto context = Context{ Param::OptionName, option_name } <<
+        Context{ Param::ExpectedArgumentCount, "2" } <<
+        Context{ Param::ReceivedArgumentCount, "1" };
+    return Context(Status::NotEnoughArguments) << context;
+}
+
+MapContext make_parsing_error_map_context(const std::string_view option_name) {
+    MapContext context;
+    context << MapContext{ { { Param::OptionName, std::string(option_name) } }, {} }
+        << MapContext{ { { Param::ExpectedArgumentCount, "2" } }, {} }
+        << MapContext{ { { Param::ReceivedArgumentCount, "1" } }, {} };
+    MapContext error{ {}, { { EnumTypes::Status, static_cast<uint32_t>(Status::NotEnoughArguments) } } };
+    return error << context;
+}
+
+} // namespace
+
+TEST(ErrorsTest, ContextDoesNotAllocate) {
+    const std::string option_name = "--an-option-name-longer-than-small-string";
+    std::size_t string_params = 0;
+
+    const std::size_t context_allocations = allocation_counter::count_allocations([&]() {
+        const Context context = make_parsing_error_context(option_name);
+        string_params = static_cast<std::size_t>(std::ranges::distance(context.get_string_params()));
+    });
+    const std::size_t map_context_allocations = allocation_counter::count_allocations([&]() {
+        const MapContext context = make_parsing_error_map_context(option_name);
+    });
+
+    std::cout << std::format("Heap allocations per error context: maps {}, inline slots {}\n",
+                             map_context_allocations, context_allocations);
+
+    EXPECT_EQ(string_params, 3u);
+    EXPECT_EQ(context_allocations, 0u);
+}
+
+TEST(ErrorsTest, ContextMoveDoesNotAllocate) {
+    static_assert(std::is_nothrow_move_constructible_v<Context> && std::is_nothrow_move_assignable_v<Context>);
+
+    const std::string long_value(2 * CONTEXT_INLINE_TEXT_SIZE, 'x'); // Moves the text to the heap
+    Context context = Context{ Param::OptionName, "--option" } << Context{ Param::ArgumentValue, long_value };
+    Context assigned{ Param::ErrorMessage, "replaced" };
+
+    const std::size_t allocations = allocation_counter::count_allocations([&]() {
+        Context constructed = std::move(context);
+        assigned = std::move(constructed);
+    });
+
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_TRUE(context.empty());
+    EXPECT_EQ(std::ranges::distance(context.get_string_params()), 0);
+
+    std::map<Param, std::string> params;
+    for (const auto [param, value] : assigned.get_string_params()) {
+        params.emplace(param, value);
+    }
+    const std::map<Param, std::string> expected{ { Param::OptionName, "--option" }, { Param::ArgumentValue, long_value } };
+    EXPECT_EQ(params, expected);
+}
+
+TEST(ErrorsTest, StacktraceSymbolizedOnceWhenRendered) {
+    auto make_error = []() {
+        return Exception(Status::UnknownError, Context{ Param::ErrorMessage, "message" },
+                         std::source_location::current(), std::stacktrace::current());
+    };
+
+    StacktraceFormatter::clear_cache();
+    std::vector<Exception> errors;
+    for (int i = 0; i < 2; ++i) {
+        errors.push_back(make_error()); // Same call site, so both traces have the same frames
+    }
+    const Exception& first = errors[0];
+    const Exception& second = errors[1];
+
+    EXPECT_EQ(StacktraceFormatter::cache_size(), 0u) << "Capturing a stacktrace should not symbolize it.";
+    const Context context = first.get_context();
+    EXPECT_FALSE(std::ranges::contains(context.get_string_params() | std::views::keys, Param::Stacktrace));
+
+    const std::string first_trace = StacktraceFormatter::format(first.get_stacktrace().value());
+    const size_t resolved_frames = StacktraceFormatter::cache_size();
+    const std::string second_trace = StacktraceFormatter::format(second.get_stacktrace().value());
+
+    EXPECT_GT(resolved_frames, 0u);
+    EXPECT_EQ(StacktraceFormatter::cache_size(), resolved_frames) << "Frames from the same site should come from the cache.";
+    EXPECT_EQ(first_trace, second_trace);
+}
+
+namespace {
+
+// Puts the stacktrace policy back to the build default when a test ends
+struct DefaultStacktracePolicy {
+    ~DefaultStacktracePolicy() {
+        if constexpr (CONSTEXPR_IS_DEBUG) {
+            StacktracePolicy::set_always();
+        }
+        else {
+            StacktracePolicy::set_off();
+        }
+    }
+};
+
+ExpectedVoid failing_function(const Status status) {
+    return make_unexpected(status, Context{ Param::ErrorMessage, "message" });
+}
+
+int count_stacktraces(const int errors, const Status status = Status::ParsingError) {
+    int stacktraces = 0;
+    for (int i = 0; i < errors; ++i) {
+        stacktraces += failing_function(status).error().get_stacktrace().has_value() ? 1 : 0;
+    }
+    return stacktraces;
+}
+
+} // namespace
+
+TEST(ErrorsTest, StacktracePolicyModes) {
+    DefaultStacktracePolicy restore_policy;
+
+    StacktracePolicy::set_off();
+    EXPECT_EQ(count_stacktraces(10), 0);
+
+    StacktracePolicy::set_always();
+    EXPECT_EQ(count_stacktraces(10), 10);
+    EXPECT_TRUE(Exception(Status::UnknownError).get_stacktrace().has_value());
+
+    StacktracePolicy::set_status_allow_list({ Status::UnknownError });
+    EXPECT_EQ(count_stacktraces(10, Status::ParsingError), 0);
+    EXPECT_EQ(count_stacktraces(10, Status::UnknownError), 10);
+
+    // Errors counted under an earlier sampling setting do not carry over
+    StacktracePolicy::set_sampling(4);
+    EXPECT_EQ(count_stacktraces(3), 0);
+    StacktracePolicy::set_sampling(4);
+    EXPECT_EQ(count_stacktraces(100), 25);
+
+    StacktracePolicy::set_rate_limit(2, std::chrono::hours(1));
+    EXPECT_EQ(count_stacktraces(10), 2) << "All errors come from the same source location.";
+}
+
+TEST(ErrorsTest, ExceptionContextBuiltOnce) {
+    const Exception exception(Status::InvalidValue, Context{ Param::ArgumentValue, "value" }, std::source_location::current(), std::nullopt);
+
+    const Context& context = exception.get_context();
+    const Exception copy = exception;
+    size_t string_params = 0;
+    const std::size_t allocations = allocation_counter::count_allocations([&]() {
+        for (int i = 0; i < 10; ++i) {
+            string_params += static_cast<size_t>(std::ranges::distance(exception.get_context().get_string_params()));
+        }
+        EXPECT_EQ(&copy.get_context(), &context) << "Copies should share the merged context.";
+    });
+
+    EXPECT_EQ(allocations, 0u) << "The merged context should be built once and returned by reference.";
+    EXPECT_EQ(string_params, 10u * 4u); // Argument value, source file, line and column
+    EXPECT_EQ(*context.get_enum_params().find(EnumTypes::Status), static_cast<std::uint32_t>(Status::InvalidValue));
+}
+
+TEST(ErrorsTest, ExceptionContextSharedBetweenThreads) {
+    const Exception exception(Status::InvalidValue, Context{ Param::ArgumentValue, "value" }, std::source_location::current(), std::nullopt);
+
+    std::vector<const Context*> contexts(8);
+    {
+        std::vector<std::jthread> threads;
+        for (const Context*& context : contexts) {
+            threads.emplace_back([&exception, &context] { context = &exception.get_context(); });
+        }
+    }
+
+    for (const Context* context : contexts) {
+        EXPECT_EQ(context, contexts.front()) << "Concurrent callers should all get the one merged context.";
+    }
+}
+
+TEST(ErrorsTest, CompactErrorPayload) {
+    static_assert(sizeof(Error) == 16);
+    std::cout << std::format("sizeof(ExpectedVoid): {}, sizeof(Exception): {}\n", sizeof(ExpectedVoid), sizeof(Exception));
+
+    ExpectedVoid plain_result;
+    const std::source_location location = std::source_location::current();
+    const std::size_t plain_allocations = allocation_counter::count_allocations([&]() {
+        plain_result = make_unexpected(Status::OptionNotFound, Context{}, location, std::nullopt);
+    });
+    EXPECT_EQ(plain_allocations, 0u) << "An error without context should not allocate.";
+    EXPECT_EQ(plain_result.error().get_error(), Status::OptionNotFound);
+    EXPECT_EQ(plain_result.error().get_location().line, location.line());
+    const Context plain_context = plain_result.error().get_context();
+    EXPECT_EQ(*plain_context.get_enum_params().find(EnumTypes::Status), static_cast<std::uint32_t>(Status::OptionNotFound));
+    EXPECT_FALSE(plain_result.error().get_stacktrace().has_value()) << "Reading a plain error should not attach an Exception.";
+    EXPECT_EQ(plain_result.error().get_cached_context(), nullptr);
+
+    volatile int sink = 0;
+    const auto detailed_result = try_test_function(true, sink);
+    const Error copy = detailed_result.error();
+    EXPECT_EQ(copy.get_error(), Status::UnknownError);
+    const Context context = copy.get_context();
+    EXPECT_EQ(*context.get_enum_params().find(EnumTypes::Message), static_cast<std::uint32_t>(Message::ExpectedKeyAndValue));
+
+    const Context* cached_context = copy.get_cached_context();
+    ASSERT_NE(cached_context, nullptr);
+    const std::size_t cached_allocations = allocation_counter::count_allocations([&]() {
+        EXPECT_EQ(copy.get_cached_context(), cached_context);
+    });
+    EXPECT_EQ(cached_allocations, 0u) << "The cached context should be returned by reference, not copied.";
+
+    try {
+        copy.throw_self();
+        FAIL() << "throw_self should throw";
+    }
+    catch (const Exception& exception) {
+        EXPECT_EQ(exception.get_error(), Status::UnknownError);
+        EXPECT_EQ(std::ranges::distance(exception.get_context().get_string_params()), 4); // Message, file, line and column
+    }
+}
+
+namespace {
+enum class Color {
+    Red,
+    Green,
+    Blue,
+};
+}
+
+TEST(ErrorsTest, EnumNameTables) {
+    static_assert(enum_name(Status::ParsingError) == "ParsingError");
+    static_assert(enum_name(Param::OptionName) == "OptionName");
+    static_assert(enum_name(static_cast<Message>(100)).empty());
+
+    EXPECT_EQ(enum_to_string(EnumTypes::Status, static_cast<uint32_t>(Status::InvalidValue)), "InvalidValue");
+    EXPECT_EQ(enum_type_name(EnumTypes::Message), "Message");
+    EXPECT_THROW(enum_type_name(static_cast<EnumTypes>(MAX_ENUM_TYPES)), Exception);
+
+    // A user enum joins the table the first time it is used
+    const Context context = Context{} << Color::Green << Status::ParsingError;
+    const EnumTypes color_type = EnumRegistry::register_enum<Color>();
+    EXPECT_GE(static_cast<size_t>(color_type), static_cast<size_t>(EnumTypes::Message) + 1);
+    EXPECT_EQ(enum_type(Color::Blue), color_type);
+    EXPECT_EQ(enum_type_name(color_type), "Color");
+    ASSERT_NE(context.get_enum_params().find(color_type), nullptr);
+    EXPECT_EQ(enum_to_string(color_type, *context.get_enum_params().find(color_type)), "Green");
+
+    auto sink = std::make_shared<RingBufferSink>(4096);
+    Logger::set_sink(sink);
+    Logger::log("enum names", context);
+    Logger::set_sink(nullptr);
+    EXPECT_NE(sink->contents().find("[Color : Green]"), std::string::npos);
+    EXPECT_NE(sink->contents().find("[Status : ParsingError]"), std::string::npos);
+}
+
+TEST(ErrorsTest, EnumNameLookupDoesNotAllocate) {
+    constexpr auto status_count = static_cast<uint32_t>(Status::FileError) + 1;
+    size_t name_length = 0;
+
+    const std::size_t allocations = allocation_counter::count_allocations([&]() {
+        for (uint32_t status = 0; status < status_count; ++status) {
+            name_length += enum_to_string(EnumTypes::Status, status).size();
+        }
+    });
+
+    EXPECT_GT(name_length, 0u);
+    EXPECT_EQ(allocations, 0u) << "Names should come from the tables instead of new strings.";
+}
+
+TEST(ErrorsTest, EnumContextsDoNotAllocate) {
+    static constexpr EnumsMap enums = create_enum_map(Status::ParsingError, Message::ExpectedKeyAndValue, Status::InvalidValue);
+    static_assert(enums.size() == 2);
+    static_assert(*enums.find(EnumTypes::Status) == static_cast<uint32_t>(Status::InvalidValue));
+
+    size_t enum_params = 0;
+    const std::size_t allocations = allocation_counter::count_allocations([&]() {
+        const Context from_operator = Context{} << Message::ExpectedKeyAndValue << Status::ParsingError;
+        const Context from_pack(Status::ParsingError, Message::ExpectedKeyAndValue);
+        const Context from_map(enums);
+        enum_params = from_operator.get_enum_params().size() + from_pack.get_enum_params().size() +
+            from_map.get_enum_params().size();
+    });
+
+    EXPECT_EQ(enum_params, 6u);
+    EXPECT_EQ(allocations, 0u);
+}
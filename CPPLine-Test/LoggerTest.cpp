@@ -0,0 +1,391 @@
+#include "pch.h"
+#include <gtest/gtest.h>
+
+#include "../CPPLine/Macros.hpp"
+
+import CPPLine;
+
+import std;
+
+using namespace cppline::errors;
+
+namespace {
+
+// Sends std::cout into a string for the lifetime of the object
+class CaptureOutput {
+public:
+    CaptureOutput() : m_previous(std::cout.rdbuf(m_output.rdbuf())) {}
+    ~CaptureOutput() { std::cout.rdbuf(m_previous); }
+
+    std::string text() const { return m_output.str(); }
+
+private:
+    std::ostringstream m_output;
+    std::streambuf* m_previous;
+};
+
+size_t count_lines(const std::string& text, const std::string_view prefix) {
+    size_t lines = 0;
+    for (const auto line : std::views::split(text, '\n')) {
+        lines += std::string_view(line).starts_with(prefix) ? 1 : 0;
+    }
+    return lines;
+}
+
+// Logs from several threads at once
+void log_from_threads(const int thread_count, const int messages_per_thread) {
+    std::vector<std::jthread> threads;
+    for (int thread = 0; thread < thread_count; ++thread) {
+        threads.emplace_back([thread, messages_per_thread] {
+            for (int i = 0; i < messages_per_thread; ++i) {
+                Logger::log(std::format("thread {} message {}", thread, i),
+                            Context{ Param::OptionName, "--option" } << Context{ Param::Index, "1" });
+            }
+        });
+    }
+}
+
+} // namespace
+
+TEST(LoggerTest, AsyncWritesEveryRecordInOrder) {
+    constexpr int thread_count = 4;
+    constexpr int messages_per_thread = 2'000;
+
+    CaptureOutput output;
+    Logger::start_async({ .capacity = 64, .overflow = OverflowPolicy::Block });
+    log_from_threads(thread_count, messages_per_thread);
+    Logger::flush();
+    Logger::stop_async();
+
+    const std::string text = output.text();
+    EXPECT_EQ(count_lines(text, "Log Message: thread"), static_cast<size_t>(thread_count * messages_per_thread));
+
+    // Records of one thread keep their order
+    size_t previous = 0;
+    for (int i = 0; i < messages_per_thread; ++i) {
+        const size_t position = text.find(std::format("thread 0 message {}\n", i));
+        ASSERT_NE(position, std::string::npos);
+        EXPECT_GE(position, previous);
+        previous = position;
+    }
+}
+
+TEST(LoggerTest, AsyncDropPolicyCountsDroppedRecords) {
+    constexpr int messages = 10'000;
+
+    CaptureOutput output;
+    Logger::start_async({ .capacity = 8, .max_batch = 1, .overflow = OverflowPolicy::Drop });
+    for (int i = 0; i < messages; ++i) {
+        Logger::log(std::format("message {}", i));
+    }
+    Logger::flush();
+    const size_t dropped = Logger::dropped_count();
+    Logger::stop_async();
+
+    EXPECT_EQ(count_lines(output.text(), "message ") + dropped, static_cast<size_t>(messages));
+}
+
+namespace {
+
+// Counts the lines written that contain a marker, written by the background thread and read by the test
+class MarkerCountingSink final : public LogSink {
+public:
+    explicit MarkerCountingSink(std::string marker) : m_marker(std::move(marker)) {}
+
+    void write(const std::string_view text) override {
+        size_t count = 0;
+        for (size_t position = text.find(m_marker); position != std::string_view::npos;
+             position = text.find(m_marker, position + m_marker.size())) {
+            ++count;
+        }
+        m_count.fetch_add(count, std::memory_order_release);
+    }
+
+    size_t count() const { return m_count.load(std::memory_order_acquire); }
+
+private:
+    std::string m_marker;
+    std::atomic<size_t> m_count = 0;
+};
+
+} // namespace
+
+TEST(LoggerTest, AsyncFlushWaitsForOwnRecordsWhileOthersPush) {
+    constexpr int producer_count = 3;
+    constexpr int messages_per_producer = 20'000; // Bounded, so a machine with few cores still finishes quickly
+    constexpr int flushes = 200;
+
+    auto sink = std::make_shared<MarkerCountingSink>("flushed message");
+    Logger::set_sink(sink);
+    Logger::start_async({ .capacity = 64, .max_batch = 8, .overflow = OverflowPolicy::Block });
+
+    std::vector<std::jthread> producers;
+    for (int thread = 0; thread < producer_count; ++thread) {
+        producers.emplace_back([thread] {
+            for (int i = 0; i < messages_per_producer; ++i) {
+                Logger::log(std::format("producer {} message {}", thread, i));
+            }
+        });
+    }
+
+    size_t missing = 0;
+    for (int i = 0; i < flushes; ++i) {
+        Logger::log(std::format("flushed message {}", i));
+        Logger::flush();
+        missing += sink->count() == static_cast<size_t>(i + 1) ? 0 : 1;
+    }
+
+    producers.clear();
+    Logger::stop_async();
+    Logger::set_sink(nullptr);
+
+    EXPECT_EQ(missing, 0u) << "flush should only return once the caller's own records are written.";
+}
+
+namespace {
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+std::filesystem::path make_log_directory(const std::string_view name) {
+    const auto directory = std::filesystem::temp_directory_path() / "cppline-logger-test" / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+} // namespace
+
+TEST(LoggerTest, FileAndMemorySinks) {
+    const auto directory = make_log_directory("sinks");
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        expected += std::format("line {}\n", i);
+    }
+
+    auto log_lines = [](std::shared_ptr<LogSink> sink) {
+        Logger::set_sink(std::move(sink));
+        for (int i = 0; i < 100; ++i) {
+            Logger::log(std::format("line {}", i));
+        }
+        Logger::flush();
+        Logger::set_sink(nullptr);
+    };
+
+    log_lines(BufferedFileSink::open(directory / "buffered.log", 256));
+    EXPECT_EQ(read_file(directory / "buffered.log"), expected);
+
+    // Small files, so the text spreads over the current file and two rotated ones. Lines are not split.
+    log_lines(MemoryMappedFileSink::open(directory / "mapped.log", 300, 2));
+    std::string mapped;
+    for (const auto* name : { "mapped.log.2", "mapped.log.1", "mapped.log" }) {
+        const std::string file = read_file(directory / name);
+        EXPECT_TRUE(file.starts_with("line ") && file.ends_with('\n') && file.size() <= 300u) << name;
+        mapped += file;
+    }
+    EXPECT_TRUE(expected.ends_with(mapped));
+    EXPECT_GT(mapped.size(), 300u * 2 - 2 * sizeof("line 99"));
+
+    auto ring = std::make_shared<RingBufferSink>(64);
+    log_lines(ring);
+    EXPECT_EQ(ring->contents(), expected.substr(expected.size() - 64));
+
+    EXPECT_FALSE(BufferedFileSink::try_open(directory / "missing" / "file.log").has_value());
+}
+
+TEST(LoggerTest, MappedFileSinkRecoversFromFailedRotation) {
+    const auto directory = make_log_directory("failed-rotation");
+    auto sink = MemoryMappedFileSink::open(directory / "mapped.log", 16, 1);
+    sink->write("0123456789\n");
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    if (error || std::filesystem::exists(directory)) {
+        GTEST_SKIP() << "The open log file keeps its directory from being removed on this platform.";
+    }
+
+    sink->write("does not fit\n"); // Rotates, and the new file cannot be created
+    sink->write("dropped\n");
+    EXPECT_EQ(sink->dropped_bytes(), 21u);
+
+    std::filesystem::create_directories(directory);
+    sink->write("written\n");
+    EXPECT_EQ(sink->dropped_bytes(), 21u);
+    sink.reset(); // Cuts the file down to the text written
+    EXPECT_EQ(read_file(directory / "mapped.log"), "written\n");
+}
+
+TEST(LoggerTest, BinaryEncodingDecodesToText) {
+    auto log_records = [](const LogEncoding encoding) {
+        auto sink = std::make_shared<RingBufferSink>(64 * 1024);
+        Logger::set_sink(sink);
+        Logger::set_encoding(encoding);
+        Logger::log("plain message");
+        Logger::log("with context", Context{ Param::OptionName, "--option" } << Context{ Param::Index, "1" });
+        Logger::log(Context{ Param::ArgumentValue, "value" } << Status::InvalidValue);
+        Logger::log("with enums", Status::ParsingError, Message::ExpectedKeyAndValue);
+        Logger::log(Status::MissingArgument);
+        Logger::log("with exception",
+                    Exception(Status::InvalidValue, Context{ Param::ErrorMessage, "bad" }, std::source_location::current(), std::nullopt));
+        Logger::flush();
+        Logger::set_encoding(LogEncoding::Text);
+        Logger::set_sink(nullptr);
+        return sink->contents();
+    };
+
+    const std::string text = log_records(LogEncoding::Text);
+    const std::string binary = log_records(LogEncoding::Binary);
+    EXPECT_EQ(binary.find("Context:"), std::string::npos);
+
+    std::string decoded;
+    ASSERT_TRUE(Logger::decode_binary(binary, decoded).has_value());
+    EXPECT_EQ(decoded, text);
+
+    std::string truncated;
+    const auto result = Logger::decode_binary(std::string_view(binary).substr(0, binary.size() - 1), truncated);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().get_error(), Status::ParsingError);
+}
+
+namespace {
+
+enum class Fruit { Apple, Banana };
+
+} // namespace
+
+TEST(LoggerTest, BinaryEncodingKeepsRegisteredEnumNames) {
+    auto log_records = [](const LogEncoding encoding) {
+        auto sink = std::make_shared<RingBufferSink>(64 * 1024);
+        Logger::set_sink(sink);
+        Logger::set_encoding(encoding);
+        Logger::log("registered enum", Fruit::Banana, Status::InvalidValue);
+        Logger::log(Context{ Param::OptionName, "--fruit" } << Fruit::Apple);
+        Logger::flush();
+        Logger::set_encoding(LogEncoding::Text);
+        Logger::set_sink(nullptr);
+        return sink->contents();
+    };
+
+    const std::string text = log_records(LogEncoding::Text);
+    std::string binary = log_records(LogEncoding::Binary);
+    EXPECT_NE(text.find(enum_name(Fruit::Banana)), std::string::npos);
+
+    // Give Fruit an id nothing is registered for, as if a process with other registrations had logged it.
+    // Each Fruit entry is: u8 id, u32 value, u32 length + type name.
+    constexpr auto unregistered_id = static_cast<char>(MAX_ENUM_TYPES - 1);
+    ASSERT_EQ(EnumRegistry::find(static_cast<EnumTypes>(unregistered_id)), nullptr);
+    const std::string_view type_name = enum_type_name(enum_type(Fruit::Apple));
+    size_t patched = 0;
+    for (size_t position = binary.find(type_name); position != std::string::npos;
+         position = binary.find(type_name, position + 1)) {
+        binary[position - 2 * sizeof(std::uint32_t) - 1] = unregistered_id;
+        ++patched;
+    }
+    ASSERT_EQ(patched, 2u);
+
+    std::string decoded;
+    ASSERT_TRUE(Logger::decode_binary(binary, decoded).has_value());
+    EXPECT_EQ(decoded, text);
+}
+
+TEST(LoggerTest, BinaryRecordsDecodeAcrossRotatedFiles) {
+    constexpr size_t file_size = 512;
+    constexpr size_t max_rotated_files = 64;
+    const auto directory = make_log_directory("binary-rotation");
+    const std::string long_message(2 * file_size, 'x'); // One record over three files
+
+    auto log_records = [&](std::shared_ptr<LogSink> sink, const LogEncoding encoding) {
+        Logger::set_sink(std::move(sink));
+        Logger::set_encoding(encoding);
+        for (int i = 0; i < 40; ++i) {
+            Logger::log(std::format("record {}", i), Context{ Param::OptionName, "--option" } << Status::InvalidValue);
+            if (i == 20) {
+                Logger::log(long_message);
+            }
+        }
+        Logger::flush();
+        Logger::set_encoding(LogEncoding::Text);
+        Logger::set_sink(nullptr);
+    };
+
+    auto text_sink = std::make_shared<RingBufferSink>(64 * 1024);
+    log_records(text_sink, LogEncoding::Text);
+    log_records(MemoryMappedFileSink::open(directory / "binary.log", file_size, max_rotated_files), LogEncoding::Binary);
+
+    // Oldest first, like the arguments of the LogDecoder
+    std::vector<std::string> files;
+    for (size_t index = max_rotated_files; index >= 1; --index) {
+        const auto path = directory / std::format("binary.log.{}", index);
+        if (std::filesystem::exists(path)) {
+            files.push_back(read_file(path));
+        }
+    }
+    files.push_back(read_file(directory / "binary.log"));
+    ASSERT_GT(files.size(), 4u);
+
+    std::string binary;
+    size_t whole_files = 0;
+    for (const std::string& file : files) {
+        std::string decoded;
+        whole_files += Logger::decode_binary(file, decoded).has_value() ? 1 : 0;
+        binary += file;
+    }
+    EXPECT_EQ(whole_files, files.size() - 3) << "Only the files holding the long record should be cut.";
+
+    std::string decoded;
+    ASSERT_TRUE(Logger::decode_binary(binary, decoded).has_value());
+    EXPECT_EQ(decoded, text_sink->contents());
+
+    // The unused tail of a mapped file that was not closed
+    std::string with_zero_tail;
+    ASSERT_TRUE(Logger::decode_binary(binary + std::string(file_size, '\0'), with_zero_tail).has_value());
+    EXPECT_EQ(with_zero_tail, decoded);
+}
+
+TEST(LoggerTest, LevelsFilterRecords) {
+    CaptureOutput output;
+    Logger::set_level(LogLevel::Warn);
+    Logger::log(LogLevel::Info, "info message");
+    Logger::log(LogLevel::Warn, "warn message");
+    Logger::log("default level message");
+    Logger::log(LogLevel::Debug, "debug context", Context{ Param::OptionName, "--option" });
+    Logger::log(LogLevel::Error, Status::ParsingError);
+    Logger::log("error message", Exception(Status::InvalidValue, {}, std::source_location::current(), std::nullopt));
+    Logger::set_level(LogLevel::Info);
+
+    const std::string text = output.text();
+    EXPECT_EQ(text.find("info message"), std::string::npos);
+    EXPECT_EQ(text.find("default level message"), std::string::npos);
+    EXPECT_EQ(text.find("debug context"), std::string::npos);
+    EXPECT_NE(text.find("warn message"), std::string::npos);
+    EXPECT_NE(text.find("ParsingError"), std::string::npos);
+    EXPECT_NE(text.find("error message"), std::string::npos);
+
+    Logger::set_level(LogLevel::Off);
+    EXPECT_FALSE(Logger::is_enabled(LogLevel::Error));
+    Logger::set_level(LogLevel::Info);
+}
+
+TEST(LoggerTest, DisabledLevelsSkipArguments) {
+    int evaluated = 0;
+    auto message = [&evaluated] {
+        ++evaluated;
+        return std::string("message");
+    };
+
+    CaptureOutput output;
+    Logger::set_level(LogLevel::Info);
+    CPPLINE_LOG(Debug, message(), Context{ Param::OptionName, "--option" });
+    EXPECT_EQ(evaluated, 0);
+
+    CPPLINE_LOG(Warn, message());
+    EXPECT_EQ(evaluated, 1);
+
+    // Compiled out below CPPLINE_LOG_MIN_LEVEL, even when enabled at runtime
+    Logger::set_level(LogLevel::Trace);
+    CPPLINE_LOG(Trace, message());
+    Logger::set_level(LogLevel::Info);
+    EXPECT_EQ(evaluated, CPPLINE_LOG_MIN_LEVEL > CPPLINE_LOG_LEVEL_TRACE ? 1 : 2);
+}
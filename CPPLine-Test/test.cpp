@@ -3,6 +3,8 @@
 #include <gtest/gtest.h>
 import CPPLine;
 
+import std;
+
 using namespace cppline::errors;
 
 TEST(ParserTest, AddBoolOption) {
@@ -79,7 +81,7 @@ TEST(ParserCustomTypeTest, CustomKeyValueOption) {
 
         // Add a custom key-value pair option
         parser.add_option("--keyvalue", "Set a key-value pair",
-                          [](const std::vector<std::string_view>& args) -> std::any {
+                          [](std::span<const std::string_view> args) -> std::any {
                               if (args.size() < 2) {
                                   throw cppline::errors::Exception(
                                       cppline::errors::Status::MissingArgument,
@@ -113,7 +115,7 @@ TEST(ParserCustomTypeTest, MissingKeyValueArguments) {
 
         // Add a custom key-value pair option
         parser.add_option("--keyvalue", "Set a key-value pair",
-                          [](const std::vector<std::string_view>& args) -> std::any {
+                          [](std::span<const std::string_view> args) -> std::any {
                               if (args.size() < 2) {
                                   throw cppline::errors::Exception(
                                       cppline::errors::Status::MissingArgument,
@@ -236,4 +238,245 @@ TEST(ParserTest, TryGetOptionFailure) {
     EXPECT_FALSE(parse_result.has_value());
 
     Logger::log("Expected parsing error", parse_result.error());
-}
\ No newline at end of file
+}
+
+TEST(ParserTest, ParseLargeArgumentList) {
+    constexpr int option_count = 5'000;
+
+    cppline::Parser parser("Test Parser");
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+    for (int i = 0; i < option_count; ++i) {
+        names.push_back(std::format("--option{}", i));
+        values.push_back(std::to_string(i));
+        parser.add_int(names.back(), "Generated option");
+    }
+
+    std::vector<std::string_view> args;
+    for (int i = 0; i < option_count; ++i) {
+        args.push_back(names[i]);
+        args.push_back(values[i]);
+    }
+
+    auto parse_result = parser.try_parse(args);
+    ASSERT_TRUE(parse_result.has_value());
+
+    EXPECT_EQ(parser.get<int>("--option0"), 0);
+    EXPECT_EQ(parser.get<int>(names.back()), option_count - 1);
+}
+
+TEST(ParserTest, PositionalFollowedByOptions) {
+    cppline::Parser parser("Test Parser");
+    parser.add_int("Number argument");
+    parser.add_string("String argument");
+    parser.add_int("--count", "Count option");
+    parser.add_bool("--flag", "Flag option");
+
+    const std::vector<std::string_view> args{ "42", "str", "--count", "7", "--flag" };
+    auto parse_result = parser.try_parse(args);
+    ASSERT_TRUE(parse_result.has_value());
+
+    EXPECT_EQ(parser.get_positional<int>(0), 42);
+    EXPECT_EQ(parser.get_positional<std::string>(1), "str");
+    EXPECT_EQ(parser.get<int>("--count"), 7);
+    EXPECT_TRUE(parser.get<bool>("--flag"));
+}
+
+TEST(ParserTest, GetByStringView) {
+    cppline::Parser parser("Test Parser");
+    parser.add_int(std::vector<std::string>{ "--number", "-n" }, "Number option", 0);
+
+    const std::vector<std::string_view> args{ "-n", "42" };
+    parser.parse(args);
+
+    constexpr std::string_view name = "--number";
+    auto number_result = parser.try_get<int>(name);
+    ASSERT_TRUE(number_result.has_value());
+    EXPECT_EQ(number_result.value(), 42);
+    EXPECT_EQ(parser.get<int>(name.substr(0, 8)), 42);
+
+    auto missing_result = parser.try_get<int>(std::string_view{ "--missing" });
+    ASSERT_FALSE(missing_result.has_value());
+    EXPECT_EQ(missing_result.error().get_error(), Status::OptionNotFound);
+}
+
+TEST(ParserTest, FreezeKeepsLookups) {
+    cppline::Parser parser("Test Parser");
+    parser.add_int(std::vector<std::string>{ "--number", "-n" }, "Number option", 0);
+    parser.add_bool("--flag", "Flag option");
+
+    parser.freeze();
+    EXPECT_TRUE(parser.is_frozen());
+    EXPECT_EQ(parser.try_get<int>("--missing").error().get_error(), Status::OptionNotFound);
+
+    // Registering after a freeze goes back to the registration map
+    parser.add_string("--name", "Name option", "default");
+    EXPECT_FALSE(parser.is_frozen());
+
+    const std::vector<std::string_view> args{ "-n", "42", "--name", "value", "--flag" };
+    parser.parse(args);
+    EXPECT_TRUE(parser.is_frozen());
+
+    EXPECT_EQ(parser.get<int>("--number"), 42);
+    EXPECT_EQ(parser.get<std::string>("--name"), "value");
+    EXPECT_TRUE(parser.get<bool>("--flag"));
+}
+
+TEST(StaticParserTest, ParseAndGet) {
+    using cppline::StaticOption;
+    cppline::StaticParser<StaticOption<int, "--count", "-c">,
+                          StaticOption<bool, "--verbose", "-v">,
+                          StaticOption<std::string, "--name">> parser;
+
+    const std::vector<std::string_view> args{ "-c", "5", "--name", "value" };
+    auto parse_result = parser.try_parse(args);
+    ASSERT_TRUE(parse_result.has_value());
+
+    EXPECT_EQ(parser.get<"--count">(), 5);
+    EXPECT_EQ(parser.get<"-c">(), 5);
+    EXPECT_EQ(parser.get<"--name">(), "value");
+    EXPECT_FALSE(parser.get<"--verbose">());
+    EXPECT_FALSE(parser.is_set<"-v">());
+    static_assert(decltype(parser)::find_index("--name") == 2);
+}
+
+TEST(StaticParserTest, Errors) {
+    using cppline::StaticOption;
+    cppline::StaticParser<StaticOption<int, "--count">> parser;
+
+    const std::vector<std::string_view> unknown{ "--unknown" };
+    EXPECT_EQ(parser.try_parse(unknown).error().get_error(), Status::OptionNotFound);
+
+    const std::vector<std::string_view> invalid{ "--count", "abc" };
+    EXPECT_EQ(parser.try_parse(invalid).error().get_error(), Status::ParsingError);
+
+    const std::vector<std::string_view> missing{ "--count" };
+    EXPECT_THROW(parser.parse(missing), cppline::errors::Exception);
+}
+
+TEST(ParserTest, TypedValueStorage) {
+    cppline::Parser parser("Test Parser");
+    parser.add_int("--number", "Number option", 0);
+    parser.add_option("--custom", "Custom option",
+                      [](std::span<const std::string_view> args) -> std::any {
+                          return static_cast<int>(args[0].size());
+                      }, 1);
+
+    const std::vector<std::string_view> args{ "--number", "42", "--custom", "abc" };
+    parser.parse(args);
+
+    // Built-in kinds held by a custom parser's std::any are stored like built-in values
+    EXPECT_EQ(parser.get<int>("--custom"), 3);
+
+    auto mismatch_result = parser.try_get<std::string>("--number");
+    ASSERT_FALSE(mismatch_result.has_value());
+    EXPECT_EQ(mismatch_result.error().get_error(), Status::InvalidValue);
+
+    auto custom_mismatch_result = parser.try_get<std::pair<int, int>>("--custom");
+    ASSERT_FALSE(custom_mismatch_result.has_value());
+    EXPECT_EQ(custom_mismatch_result.error().get_error(), Status::InvalidValue);
+}
+
+TEST(ParserTest, NumericOptions) {
+    cppline::Parser parser("Test Parser");
+    parser.add_int("--int", "Int option");
+    parser.add_int64("--int64", "Int64 option");
+    parser.add_uint64("--uint64", "Uint64 option");
+    parser.add_double("--double", "Double option");
+    parser.add_int("--hex", "Hex option");
+
+    const std::vector<std::string_view> args{ "--int", "-1'000", "--int64", "-9223372036854775808",
+                                              "--uint64", "0xFFFF_FFFF_FFFF_FFFF", "--double", "2.5e-1",
+                                              "--hex", "0b1010" };
+    parser.parse(args);
+
+    EXPECT_EQ(parser.get<int>("--int"), -1000);
+    EXPECT_EQ(parser.get<std::int64_t>("--int64"), std::numeric_limits<std::int64_t>::min());
+    EXPECT_EQ(parser.get<std::uint64_t>("--uint64"), std::numeric_limits<std::uint64_t>::max());
+    EXPECT_DOUBLE_EQ(parser.get<double>("--double"), 0.25);
+    EXPECT_EQ(parser.get<int>("--hex"), 10);
+}
+
+TEST(ParserTest, InvalidNumbers) {
+    for (const std::string_view invalid : { "12ab", "", "-", "1__0", "_1", "0x", "99999999999" }) {
+        EXPECT_FALSE(cppline::parse_number<int>(invalid).has_value()) << invalid;
+    }
+    EXPECT_FALSE(cppline::parse_number<std::uint64_t>("-1").has_value());
+    EXPECT_EQ(cppline::parse_number<int>("0o17").value(), 15);
+    EXPECT_EQ(cppline::parse_number<int>("+0x1F").value(), 31);
+}
+
+namespace {
+
+// Counts what a Parser allocates from the resource passed to its constructor
+class UpstreamCounter final : public std::pmr::memory_resource {
+public:
+    std::uint64_t allocations = 0;
+    std::uint64_t allocated_bytes = 0;
+
+private:
+    void* do_allocate(const size_t bytes, const size_t alignment) override {
+        ++allocations;
+        allocated_bytes += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* pointer, const size_t bytes, const size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+TEST(ParserTest, ParserStats) {
+    UpstreamCounter upstream;
+    cppline::Parser parser("A description too long for the small string buffer of any standard library", &upstream);
+    parser.add_int("Positional option");
+    parser.add_bool("--verbose", "Bool option");
+    parser.add_option("--pair", "Custom option", [](std::span<const std::string_view> args) -> Expected<std::any> {
+        return std::make_pair(std::string(args[0]), std::string(args[1]));
+    }, 2);
+
+    // Everything the Parser allocates, including its description, goes through the counting resource
+    const cppline::ParserStats registration = parser.get_stats();
+    if constexpr (cppline::PARSER_STATS_ENABLED) {
+        EXPECT_GT(registration.allocations, 0u);
+        EXPECT_EQ(registration.allocations, upstream.allocations);
+        EXPECT_EQ(registration.allocated_bytes, upstream.allocated_bytes);
+    }
+
+    parser.reset_stats();
+    upstream.allocations = 0;
+    upstream.allocated_bytes = 0;
+    const std::vector<std::string_view> args{ "5", "--verbose", "--pair", "key", "value" };
+    parser.parse(args);
+    EXPECT_FALSE(parser.try_parse(std::vector<std::string_view>{ "1", "--unknown" }).has_value());
+
+    const cppline::ParserStats stats = parser.get_stats();
+    if constexpr (!cppline::PARSER_STATS_ENABLED) {
+        EXPECT_EQ(stats.parse_calls, 0u);
+        EXPECT_EQ(stats.allocations, 0u);
+        EXPECT_TRUE(stats.errors.empty());
+        return;
+    }
+
+    EXPECT_GT(stats.allocations, 0u); // The first parse freezes the option table
+    EXPECT_EQ(stats.allocations, upstream.allocations);
+    EXPECT_EQ(stats.allocated_bytes, upstream.allocated_bytes);
+
+    EXPECT_EQ(stats.parse_calls, 2u);
+    EXPECT_EQ(stats.tokens_scanned, 7u); // The second call fails after "1" and "--unknown"
+    EXPECT_EQ(stats.option_lookups, 3u);
+    EXPECT_EQ(stats.map_lookups, 0u);
+    EXPECT_EQ(stats.parse_function_calls, 4u);
+    EXPECT_EQ(stats.custom_parse_function_calls, 1u);
+    EXPECT_EQ(stats.error_count(Status::OptionNotFound), 1u);
+    EXPECT_EQ(stats.errors.size(), 1u);
+    // Parse functions run inside the two phases
+    EXPECT_LE(stats.conversion_time, stats.positional_time + stats.non_positional_time);
+
+    parser.reset_stats();
+    EXPECT_EQ(parser.get_stats().parse_calls, 0u);
+}
@@ -0,0 +1,93 @@
+module ErrorHandling;
+
+import std;
+import :Context;
+
+namespace cppline::errors
+{
+AsyncLogWriter::AsyncLogWriter(const AsyncLoggerOptions& options, const FormatFunction format, const WriteFunction write) :
+    m_options(options),
+    m_format(format),
+    m_write(write),
+    m_ring(options.capacity),
+    m_thread([this] { run(); })
+{
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    m_stopping.store(true, std::memory_order_release);
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+    m_thread.join();
+}
+
+bool AsyncLogWriter::push(LogRecord&& record)
+{
+    while (!m_ring.try_push(std::move(record))) {
+        if (m_options.overflow == OverflowPolicy::Drop) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+    return true;
+}
+
+void AsyncLogWriter::flush()
+{
+    // The ring position is claimed inside try_push, so unlike a counter bumped after it returns,
+    // it already covers the caller's own records when other producers are pushing at the same time
+    const std::uint64_t target = m_ring.enqueued();
+    for (std::uint64_t written = m_written.load(std::memory_order_acquire);
+         written < target;
+         written = m_written.load(std::memory_order_acquire)) {
+        m_written.wait(written, std::memory_order_acquire);
+    }
+}
+
+size_t AsyncLogWriter::dropped_count() const noexcept
+{
+    return static_cast<size_t>(m_dropped.load(std::memory_order_relaxed));
+}
+
+void AsyncLogWriter::run()
+{
+    std::string batch;
+    for (;;) {
+        // Read the signal before draining: a push after the drain changes it, so the wait below returns at once
+        const std::uint32_t signal = m_signal.load(std::memory_order_acquire);
+        while (write_batch(batch) != 0) {
+        }
+
+        if (m_stopping.load(std::memory_order_acquire)) {
+            while (write_batch(batch) != 0) { // Records pushed between the drain and the stop
+            }
+            return;
+        }
+        m_signal.wait(signal, std::memory_order_acquire);
+    }
+}
+
+size_t AsyncLogWriter::write_batch(std::string& batch)
+{
+    batch.clear();
+    LogRecord record;
+    size_t count = 0;
+    while (count < m_options.max_batch && m_ring.try_pop(record)) {
+        m_format(record, batch);
+        ++count;
+    }
+
+    if (count != 0) {
+        m_write(batch);
+        m_written.fetch_add(count, std::memory_order_release);
+        m_written.notify_all();
+    }
+    return count;
+}
+
+} // namespace cppline::errors
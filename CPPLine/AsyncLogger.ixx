@@ -0,0 +1,169 @@
+export module ErrorHandling:AsyncLogger;
+
+import std;
+import :Context;
+
+export namespace cppline::errors {
+
+enum class LogRecordKind : std::uint8_t {
+    Message,
+    MessageWithException,
+    MessageWithContext,
+    Context,
+    MessageWithEnums,
+    Enums,
+};
+
+// Severity of a record. Values match the CPPLINE_LOG_LEVEL_* macros in Macros.hpp.
+enum class LogLevel : std::uint8_t {
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off, // Only as a threshold, disables logging
+};
+
+// Everything a log call needs to be rendered later, formatting happens when the record is written
+struct LogRecord {
+    LogRecordKind kind = LogRecordKind::Message;
+    LogLevel level = LogLevel::Info;
+    std::string message;
+    Context context;
+    ErrorLocation location;
+    std::optional<std::stacktrace> stacktrace;
+    std::shared_ptr<const Context> shared_context; // Merged context of a logged Exception, shared instead of copied
+
+    const Context& get_context() const
+    {
+        return shared_context != nullptr ? *shared_context : context;
+    }
+};
+
+enum class OverflowPolicy {
+    Drop,  // Discard the record, counted by Logger::dropped_count
+    Block, // Wait for the background thread to make room
+};
+
+struct AsyncLoggerOptions {
+    size_t capacity = 1024; // Records in flight, rounded up to a power of two
+    size_t max_batch = 256; // Records formatted into one write
+    OverflowPolicy overflow = OverflowPolicy::Block;
+};
+
+// Bounded lock-free queue for many producers and a single consumer (Vyukov's array queue).
+// Every cell has a sequence number telling whether it is free for the producer at that position
+// or filled for the consumer, so producers only contend on one fetch of the enqueue position.
+template <typename T>
+class MpscRing final
+{
+public:
+    explicit MpscRing(const size_t capacity) :
+        m_cells(std::make_unique<Cell[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))),
+        m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1)
+    {
+        for (size_t index = 0; index <= m_mask; ++index) {
+            m_cells[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    // Moves from value only if there was room
+    bool try_push(T&& value)
+    {
+        size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[position & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0) {
+                if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false; // Full
+            }
+            else {
+                position = m_enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Only called by the consumer thread
+    bool try_pop(T& value)
+    {
+        Cell& cell = m_cells[m_dequeue_position & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence - (m_dequeue_position + 1)) < 0) {
+            return false; // Empty
+        }
+
+        value = std::move(cell.value);
+        cell.sequence.store(m_dequeue_position + m_mask + 1, std::memory_order_release);
+        ++m_dequeue_position;
+        return true;
+    }
+
+    // Positions claimed by producers so far. Values are popped in this order, so once the consumer
+    // has popped this many, everything pushed before the call has been popped.
+    size_t enqueued() const noexcept
+    {
+        return m_enqueue_position.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> m_enqueue_position = 0;
+    alignas(std::hardware_destructive_interference_size) size_t m_dequeue_position = 0;
+};
+
+// Background thread of the asynchronous Logger: callers push records, the thread formats them in
+// batches and hands each batch to the write function in one call.
+class AsyncLogWriter final
+{
+public:
+    using FormatFunction = void (*)(const LogRecord& record, std::string& output);
+    using WriteFunction = void (*)(std::string_view text);
+
+    AsyncLogWriter(const AsyncLoggerOptions& options, FormatFunction format, WriteFunction write);
+    ~AsyncLogWriter(); // Writes the records still queued before returning
+
+    // Returns false if the record was dropped
+    bool push(LogRecord&& record);
+
+    // Waits until every record pushed before the call is written
+    void flush();
+
+    size_t dropped_count() const noexcept;
+
+    AsyncLogWriter(const AsyncLogWriter&) = delete;
+    AsyncLogWriter(AsyncLogWriter&&) = delete;
+    AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+    AsyncLogWriter& operator=(AsyncLogWriter&&) = delete;
+
+private:
+    void run();
+    size_t write_batch(std::string& batch);
+
+    AsyncLoggerOptions m_options;
+    FormatFunction m_format;
+    WriteFunction m_write;
+    MpscRing<LogRecord> m_ring;
+
+    std::atomic<std::uint64_t> m_written = 0; // Records handed to the write function, in ring order
+    std::atomic<std::uint64_t> m_dropped = 0;
+    std::atomic<std::uint32_t> m_signal = 0;  // Bumped to wake the background thread
+    std::atomic<bool> m_stopping = false;
+
+    std::thread m_thread; // Last, so it starts after everything it uses
+};
+
+} // namespace cppline::errors
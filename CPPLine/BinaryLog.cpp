@@ -0,0 +1,212 @@
+module;
+
+#include "Macros.hpp"
+
+module ErrorHandling;
+
+import std;
+
+namespace cppline::errors::binary_log
+{
+namespace {
+
+template <std::integral T>
+void put(std::string& output, T value)
+{
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    output.append(bytes, sizeof(T));
+}
+
+void put_text(std::string& output, const std::string_view text)
+{
+    put(output, static_cast<std::uint32_t>(text.size()));
+    output.append(text);
+}
+
+// Reads from the binary stream, every read fails once the input is exhausted
+class Reader final
+{
+public:
+    explicit Reader(const std::string_view input) :
+        m_input(input)
+    {
+    }
+
+    template <std::integral T>
+    Expected<T> get()
+    {
+        if (m_input.size() < sizeof(T)) {
+            return truncated();
+        }
+        T value;
+        std::memcpy(&value, m_input.data(), sizeof(T));
+        m_input.remove_prefix(sizeof(T));
+        if constexpr (std::endian::native == std::endian::big) {
+            value = std::byteswap(value);
+        }
+        return value;
+    }
+
+    Expected<std::string_view> get_text()
+    {
+        const auto length = get<std::uint32_t>();
+        return_on_error(length);
+        if (m_input.size() < length.value()) {
+            return truncated();
+        }
+        const std::string_view text = m_input.substr(0, length.value());
+        m_input.remove_prefix(length.value());
+        return text;
+    }
+
+private:
+    static std::unexpected<Error> truncated()
+    {
+        return make_unexpected(Status::ParsingError, Context{ Param::ErrorMessage, "truncated binary log record" });
+    }
+
+    std::string_view m_input;
+};
+
+bool is_known_param(const std::uint8_t id)
+{
+    return id < EnumIndexedMap<Param, std::uint8_t>::CAPACITY;
+}
+
+} // namespace
+
+void encode(const LogRecord& record, std::string& output)
+{
+    const size_t start = output.size();
+    put(output, RECORD_MARKER);
+    put(output, VERSION);
+    put(output, static_cast<std::uint8_t>(record.kind));
+    const int level = static_cast<int>(record.level) << LEVEL_SHIFT;
+    put(output, static_cast<std::uint8_t>(level | (record.stacktrace.has_value() ? HAS_STACKTRACE : 0)));
+    put(output, std::uint32_t{ 0 }); // Size, filled in below
+
+    put(output, static_cast<std::uint32_t>(record.location.line));
+    put(output, static_cast<std::uint32_t>(record.location.column));
+    put_text(output, record.location.file_name);
+    put_text(output, record.message);
+
+    const auto& enum_params = record.get_context().get_enum_params();
+    put(output, static_cast<std::uint8_t>(enum_params.size()));
+    for (const auto [key, value] : enum_params) {
+        put(output, static_cast<std::uint8_t>(key));
+        put(output, value);
+        if (static_cast<size_t>(key) >= BUILTIN_ENUM_TYPES) {
+            put_text(output, enum_type_name(key));
+            put_text(output, enum_to_string(key, value));
+        }
+    }
+
+    const auto string_params = record.get_context().get_string_params();
+    put(output, static_cast<std::uint8_t>(std::ranges::distance(string_params)));
+    for (const auto [key, value] : string_params) {
+        put(output, static_cast<std::uint8_t>(key));
+        put_text(output, value);
+    }
+
+    if (record.stacktrace.has_value()) {
+        put(output, static_cast<std::uint16_t>(record.stacktrace->size()));
+        for (const auto& frame : record.stacktrace.value()) {
+            put(output, static_cast<std::uint64_t>(std::bit_cast<std::uintptr_t>(frame.native_handle())));
+        }
+    }
+
+    std::uint32_t size = static_cast<std::uint32_t>(output.size() - start - HEADER_SIZE);
+    if constexpr (std::endian::native == std::endian::big) {
+        size = std::byteswap(size);
+    }
+    std::memcpy(output.data() + start + 4, &size, sizeof(size));
+}
+
+Expected<DecodedRecord> decode(std::string_view& input)
+{
+    Reader header(input);
+    const auto marker = header.get<std::uint8_t>();
+    const auto version = header.get<std::uint8_t>();
+    const auto kind = header.get<std::uint8_t>();
+    const auto flags = header.get<std::uint8_t>();
+    const auto size = header.get<std::uint32_t>();
+    return_on_error(size);
+
+    if (marker.value() != RECORD_MARKER || version.value() != VERSION ||
+        kind.value() > static_cast<std::uint8_t>(LogRecordKind::Enums) ||
+        (flags.value() >> LEVEL_SHIFT) > static_cast<std::uint8_t>(LogLevel::Off)) {
+        return make_unexpected(Status::ParsingError, Context{ Param::ErrorMessage, "not a binary log record" });
+    }
+    if (input.size() - HEADER_SIZE < size.value()) {
+        return make_unexpected(Status::ParsingError, Context{ Param::ErrorMessage, "truncated binary log record" });
+    }
+
+    Reader reader(input.substr(HEADER_SIZE, size.value()));
+    input.remove_prefix(HEADER_SIZE + size.value());
+
+    DecodedRecord decoded;
+    decoded.record.kind = static_cast<LogRecordKind>(kind.value());
+    decoded.record.level = static_cast<LogLevel>(flags.value() >> LEVEL_SHIFT);
+
+    const auto line = reader.get<std::uint32_t>();
+    const auto column = reader.get<std::uint32_t>();
+    const auto file_name = reader.get_text();
+    return_on_error(file_name);
+    decoded.file_name = file_name.value();
+
+    const auto message = reader.get_text();
+    return_on_error(message);
+    decoded.record.message = message.value();
+
+    const auto enum_count = reader.get<std::uint8_t>();
+    return_on_error(enum_count);
+    EnumContext enums;
+    for (std::uint8_t index = 0; index < enum_count.value(); ++index) {
+        const auto id = reader.get<std::uint8_t>();
+        const auto value = reader.get<std::uint32_t>();
+        return_on_error(value);
+        if (id.value() < BUILTIN_ENUM_TYPES) {
+            enums.insert_or_assign(static_cast<EnumTypes>(id.value()), value.value());
+            continue;
+        }
+
+        // The decoding process may have registered other enums or none, so only the names are used
+        const auto type_name = reader.get_text();
+        return_on_error(type_name);
+        const auto value_name = reader.get_text();
+        return_on_error(value_name);
+        decoded.named_enums.push_back(NamedEnum{ std::string(type_name.value()), std::string(value_name.value()) });
+    }
+    decoded.record.context = Context(enums);
+
+    const auto string_count = reader.get<std::uint8_t>();
+    return_on_error(string_count);
+    for (std::uint8_t index = 0; index < string_count.value(); ++index) {
+        const auto id = reader.get<std::uint8_t>();
+        const auto text = reader.get_text();
+        return_on_error(text);
+        if (is_known_param(id.value())) {
+            decoded.record.context << Context{ static_cast<Param>(id.value()), text.value() };
+        }
+    }
+
+    if ((flags.value() & HAS_STACKTRACE) != 0) {
+        const auto frame_count = reader.get<std::uint16_t>();
+        return_on_error(frame_count);
+        decoded.frames.emplace();
+        for (std::uint16_t index = 0; index < frame_count.value(); ++index) {
+            const auto address = reader.get<std::uint64_t>();
+            return_on_error(address);
+            decoded.frames->push_back(address.value());
+        }
+    }
+
+    decoded.record.location = ErrorLocation("", line.value(), column.value());
+    return decoded;
+}
+
+} // namespace cppline::errors::binary_log
@@ -0,0 +1,44 @@
+export module ErrorHandling:BinaryLog;
+
+import std;
+import :Context;
+import :Enums;
+import :AsyncLogger;
+import :Expected;
+
+export namespace cppline::errors {
+
+// Binary encoding of log records: param and enum ids, enum values and string payloads are written
+// as they are, nothing is formatted. Every record is self-delimiting, integers are little endian:
+//
+//   u8 marker, u8 version, u8 kind, u8 flags (level in the high four bits), u32 size of the rest of the record
+//   u32 line, u32 column, u32 length + file name, u32 length + message
+//   u8 enum count, then per enum: u8 EnumTypes id, u32 value, and for registered enums (ids from
+//     BUILTIN_ENUM_TYPES on, which only hold in the logging process) u32 length + type name, u32 length + value name
+//   u8 string count, then per string: u8 Param id, u32 length + text
+//   if flags has HAS_STACKTRACE: u16 frame count, then per frame: u64 address
+namespace binary_log {
+
+constexpr std::uint8_t RECORD_MARKER = 0xC1;
+constexpr std::uint8_t VERSION = 2;
+constexpr std::uint8_t HAS_STACKTRACE = 1;
+constexpr int LEVEL_SHIFT = 4;
+constexpr size_t HEADER_SIZE = 8;
+
+void encode(const LogRecord& record, std::string& output);
+
+// A record read back from the binary stream. Frame addresses cannot be symbolized outside the
+// process that logged them, so they are kept as numbers.
+struct DecodedRecord {
+    LogRecord record;
+    std::string file_name; // record.location.file_name is empty, it cannot point into a record that moves
+    std::optional<std::vector<std::uint64_t>> frames; // Frame addresses, nullopt if no stacktrace was logged
+    std::vector<NamedEnum> named_enums; // Registered enums, in the order the logging process rendered them
+};
+
+// Decodes the record at the start of input and removes it from input
+Expected<DecodedRecord> decode(std::string_view& input);
+
+} // namespace binary_log
+
+} // namespace cppline::errors
@@ -5,29 +5,124 @@ import :Enums;
 
 namespace cppline::errors
 {
-StringContext Context::get_string_params() const
+ContextText::ContextText(const ContextText& other) :
+    m_size(other.m_size),
+    m_overflow(other.m_overflow)
 {
-    return m_string_context;
+    if (m_overflow.empty()) {
+        copy_inline(other);
+    }
+}
+
+ContextText::ContextText(ContextText&& other) noexcept :
+    m_size(other.m_size),
+    m_overflow(std::move(other.m_overflow))
+{
+    if (m_overflow.empty()) {
+        copy_inline(other);
+    }
+    other.reset();
+}
+
+ContextText& ContextText::operator=(const ContextText& other)
+{
+    if (this != &other) {
+        m_size = other.m_size;
+        m_overflow = other.m_overflow;
+        if (m_overflow.empty()) {
+            copy_inline(other);
+        }
+    }
+    return *this;
+}
+
+ContextText& ContextText::operator=(ContextText&& other) noexcept
+{
+    if (this != &other) {
+        m_size = other.m_size;
+        m_overflow = std::move(other.m_overflow);
+        if (m_overflow.empty()) {
+            copy_inline(other);
+        }
+        other.reset();
+    }
+    return *this;
+}
+
+ContextText::Span ContextText::append(const std::string_view text)
+{
+    const Span span{ m_size, static_cast<std::uint32_t>(text.size()) };
+
+    if (m_overflow.empty() && m_size + text.size() <= m_inline.size()) {
+        std::ranges::copy(text, m_inline.data() + m_size);
+    }
+    else {
+        if (m_overflow.empty()) {
+            m_overflow.reserve(m_size + text.size());
+            m_overflow.assign(m_inline.data(), m_size);
+        }
+        m_overflow.append(text);
+    }
+
+    m_size += span.length;
+    return span;
+}
+
+std::string_view ContextText::view(const Span span) const noexcept
+{
+    return { data() + span.offset, span.length };
+}
+
+const char* ContextText::data() const noexcept
+{
+    return m_overflow.empty() ? m_inline.data() : m_overflow.data();
+}
+
+void ContextText::copy_inline(const ContextText& other) noexcept
+{
+    std::copy_n(other.m_inline.data(), std::min<size_t>(m_size, m_inline.size()), m_inline.data());
+}
+
+void ContextText::reset() noexcept
+{
+    m_size = 0;
+    m_overflow.clear(); // A moved-from string is only guaranteed to be valid, not empty
+}
+
+Context::Context(Context&& other) noexcept :
+    m_string_params(std::exchange(other.m_string_params, {})),
+    m_enum_params(std::exchange(other.m_enum_params, {})),
+    m_text(std::move(other.m_text))
+{
+}
+
+Context& Context::operator=(Context&& other) noexcept
+{
+    if (this != &other) {
+        m_string_params = std::exchange(other.m_string_params, {});
+        m_enum_params = std::exchange(other.m_enum_params, {});
+        m_text = std::move(other.m_text);
+    }
+    return *this;
 }
 
-EnumContext Context::get_enum_params() const
+const EnumParams& Context::get_enum_params() const
 {
-    return m_enum_context;
+    return m_enum_params;
 }
 
-Context::Context(StringContext str_context, EnumContext enum_context) :
-    m_string_context(std::move(str_context)),
-    m_enum_context(std::move(enum_context))
+bool Context::empty() const noexcept
 {
+    return m_string_params.empty() && m_enum_params.empty();
 }
 
-Context::Context(Param param, std::string message) :
-    m_string_context{ {param, message} }
+Context::Context(const Param param, const std::string_view message)
 {
+    add_string_param(param, message);
 }
 
-Context::Context(EnumContext enum_context) :
-    m_enum_context(std::move(enum_context))
+Context::Context(const EnumContext& enum_context) :
+    m_enum_params(enum_context)
 {
 }
 
@@ -37,37 +132,44 @@ Context& Context::operator <<(const Context& context)
         return *this;
     }
 
-    m_string_context.insert(context.m_string_context.begin(), context.m_string_context.end());
-    m_enum_context.insert(context.m_enum_context.begin(), context.m_enum_context.end());
+    for (const auto [param, message] : context.get_string_params()) {
+        add_string_param(param, message);
+    }
+    for (const auto [key, value] : context.m_enum_params) {
+        m_enum_params.try_emplace(key, value);
+    }
 
     return *this;
 }
 
 Context& Context::operator<<(const std::tuple<Param, std::string>& str_param)
 {
-    m_string_context.emplace(str_param);
+    add_string_param(std::get<Param>(str_param), std::get<std::string>(str_param));
     return *this;
 }
 
-Context location_to_context(const std::source_location& location)
+void Context::add_string_param(const Param param, const std::string_view message)
+{
+    if (!m_string_params.contains(param)) {
+        m_string_params.insert_or_assign(param, m_text.append(message));
+    }
+}
+
+Context location_to_context(const ErrorLocation& location)
 {
     Context location_context = Context{}
-        << Context{ Param::SourceFile, location.file_name() }
-        << Context{ Param::SourceLine, std::to_string(location.line()) }
-        << Context{ Param::SourceColumn, std::to_string(location.column())
-    };
+        << Context{ Param::SourceFile, location.file_name }
+        << Context{ Param::SourceLine, std::to_string(location.line) };
+
+    if (location.column != 0) {
+        location_context << Context{ Param::SourceColumn, std::to_string(location.column) };
+    }
 
     return location_context;
 }
 
 Context stacktrace_to_context(const std::stacktrace& stacktrace)
 {
-    std::string stacktrace_string = "\n";
-    for (auto stack_entry : stacktrace) {
-        std::string entry_line = std::format("{}, file: {}, line: {}\n", stack_entry.description(), stack_entry.source_file(), stack_entry.source_line());
-        stacktrace_string += entry_line;
-    }
-
-    return Context{ Param::Stacktrace, stacktrace_string };
+    return Context{ Param::Stacktrace, StacktraceFormatter::format(stacktrace) };
 }
 }
\ No newline at end of file
@@ -6,29 +6,73 @@ import :Enums;
 export namespace cppline::errors
 {
 
-using StringContext = std::unordered_map<Param, std::string>;
 using StringPair = std::tuple<Param, std::string>;
 
 using EnumContext = EnumsMap;
+using EnumParams = EnumsMap;
+
+// String params up to this many characters in total are stored inside the Context itself
+constexpr size_t CONTEXT_INLINE_TEXT_SIZE = 128;
+
+// Text of all string params of a Context back to back.
+// Kept in an inline buffer and only moved to the heap once it outgrows CONTEXT_INLINE_TEXT_SIZE.
+class ContextText final
+{
+public:
+    struct Span {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    ContextText() = default;
+    ~ContextText() = default;
+    ContextText(const ContextText& other);
+    ContextText(ContextText&& other) noexcept;
+    ContextText& operator=(const ContextText& other);
+    ContextText& operator=(ContextText&& other) noexcept;
+
+    Span append(std::string_view text);
+    std::string_view view(Span span) const noexcept;
+
+private:
+    const char* data() const noexcept;
+    void copy_inline(const ContextText& other) noexcept; // Copies the first m_size characters of other's inline buffer
+    void reset() noexcept;
+
+    std::array<char, CONTEXT_INLINE_TEXT_SIZE> m_inline; // Only the first m_size characters are initialized
+    std::uint32_t m_size = 0;
+    std::string m_overflow; // Holds all of the text once it no longer fits inline
+};
 
 export class Context final
 {
 public:
     Context() = default;
-    ~Context() = default;
-    StringContext get_string_params() const;
-    EnumContext get_enum_params() const;
+    Context(const Context&) = default;
+    Context(Context&& other) noexcept; // Leaves other empty
+    Context& operator=(const Context&) = default;
+    Context& operator=(Context&& other) noexcept;
 
-    Context(StringContext str_context, EnumContext enum_context = {});
-    Context(Param param, std::string message);
-    Context(EnumContext enum_context);
+    // Range of (Param, std::string_view) pairs in Param order, views are valid while the Context is
+    auto get_string_params() const
+    {
+        return m_string_params | std::views::transform([this](const auto& param) {
+            return std::pair{ param.first, m_text.view(param.second) };
+        });
+    }
+    const EnumParams& get_enum_params() const;
+    bool empty() const noexcept;
+
+    Context(Param param, std::string_view message);
+    Context(const EnumContext& enum_context);
 
     template <EnumType... Enums>
     explicit Context(Enums... enums) :
-        m_enum_context(create_enum_map(std::forward<Enums>(enums)...))
+        m_enum_params(create_enum_map(enums...))
     {
     }
 
+    // Params already present are kept
     Context& operator<< (const Context& context);
 
     Context& operator<< (const std::tuple<Param, std::string>& str_param);
@@ -37,17 +81,42 @@ public:
     Context& operator<< (Enum enum_value);
 
 private:
-    StringContext m_string_context;
-    EnumContext m_enum_context;
+    void add_string_param(Param param, std::string_view message);
+
+    EnumIndexedMap<Param, ContextText::Span> m_string_params;
+    EnumParams m_enum_params;
+    ContextText m_text;
 };
 
 template <EnumType Enum>
 Context& Context::operator<<(Enum enum_value)
 {
-    m_enum_context.emplace(enum_type(enum_value), static_cast<uint32_t>(enum_value));
+    m_enum_params.try_emplace(enum_type(enum_value), static_cast<uint32_t>(enum_value));
     return *this;
 }
 
-Context location_to_context(const std::source_location& location);
+// Where an error was raised. Unlike std::source_location it can be rebuilt from a file name and line,
+// which is all a compact Error keeps.
+struct ErrorLocation {
+    const char* file_name = "";
+    std::uint_least32_t line = 0;
+    std::uint_least32_t column = 0; // 0 if unknown
+
+    ErrorLocation() = default;
+    ErrorLocation(const std::source_location& location) :
+        file_name(location.file_name()),
+        line(location.line()),
+        column(location.column())
+    {
+    }
+    ErrorLocation(const char* file, const std::uint_least32_t line_number, const std::uint_least32_t column_number = 0) :
+        file_name(file),
+        line(line_number),
+        column(column_number)
+    {
+    }
+};
+
+Context location_to_context(const ErrorLocation& location);
 Context stacktrace_to_context(const std::stacktrace& stacktrace);
 }
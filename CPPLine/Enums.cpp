@@ -1,36 +1,84 @@
+module;
+
+#include "magic_enum.hpp"
+
 module ErrorHandling;
 
-import "magic_enum.hpp";
 import std;
 import :Exception;
 
-#define logger_add_enum(enum_name) \
-template <> \
-EnumTypes enum_type_helper<enum_name>(enum_name) { \
-    return EnumTypes::enum_name; \
+namespace cppline::errors {
+
+namespace {
+template <EnumType Enum>
+constexpr EnumNameTable builtin_table()
+{
+    return EnumNameTable{ magic_enum::enum_type_name<Enum>(), ENUM_NAMES<Enum> };
 }
 
-namespace cppline::errors {
+[[noreturn]] void throw_unknown_enum(const EnumTypes enum_type, const std::optional<uint32_t> enum_value = std::nullopt)
+{
+    Context context{ Param::EnumType, std::to_string(static_cast<uint32_t>(enum_type)) };
+    if (enum_value.has_value()) {
+        context << Context{ Param::EnumValue, std::to_string(enum_value.value()) };
+    }
+    throw Exception(Status::UnknownEnum, context);
+}
+}
+
+// In EnumTypes order
+std::array<EnumNameTable, MAX_ENUM_TYPES> EnumRegistry::s_tables{
+    builtin_table<EnumTypes>(),
+    builtin_table<Status>(),
+    builtin_table<Message>(),
+};
+std::atomic<size_t> EnumRegistry::s_size = BUILTIN_ENUM_TYPES;
+std::mutex EnumRegistry::s_add_mutex;
 
-logger_add_enum(Status)
-logger_add_enum(Message)
-logger_add_enum(EnumTypes)
+static_assert(BUILTIN_ENUM_TYPES == 3, "Add new built-in enums to EnumRegistry::s_tables and enum_type");
+
+const EnumNameTable* EnumRegistry::find(const EnumTypes enum_type) noexcept
+{
+    const auto index = static_cast<size_t>(enum_type);
+    return index < s_size.load(std::memory_order_acquire) ? &s_tables[index] : nullptr;
+}
 
-std::string enum_to_string(EnumTypes enum_type, uint32_t enum_value)
+size_t EnumRegistry::size() noexcept
 {
-    switch (enum_type)
-    {
-    case EnumTypes::EnumTypes:
-        return magic_enum::enum_name(static_cast<EnumTypes>(enum_value)).data();
-    case EnumTypes::Status:
-        return magic_enum::enum_name(static_cast<Status>(enum_value)).data();
-    case EnumTypes::Message:
-        return magic_enum::enum_name(static_cast<Message>(enum_value)).data();
-    default:
+    return s_size.load(std::memory_order_acquire);
+}
+
+EnumTypes EnumRegistry::add(const EnumNameTable& table)
+{
+    std::scoped_lock lock(s_add_mutex);
+    const size_t index = s_size.load(std::memory_order_relaxed);
+    if (index == MAX_ENUM_TYPES) {
         throw Exception(Status::UnknownEnum,
-                        Context{ Param::EnumType, std::to_string(static_cast<uint32_t>(enum_type)) } <<
-                        Context{ Param::EnumValue, std::to_string(enum_value) });
+                        Context{ Param::EnumType, table.type_name } <<
+                        Context{ Param::ErrorMessage, "too many registered enum types" });
     }
+
+    s_tables[index] = table;
+    s_size.store(index + 1, std::memory_order_release);
+    return static_cast<EnumTypes>(index);
 }
 
-}
\ No newline at end of file
+std::string_view enum_to_string(const EnumTypes enum_type, const uint32_t enum_value)
+{
+    const EnumNameTable* table = EnumRegistry::find(enum_type);
+    if (table == nullptr) {
+        throw_unknown_enum(enum_type, enum_value);
+    }
+    return enum_value < table->names.size() ? table->names[enum_value] : std::string_view{};
+}
+
+std::string_view enum_type_name(const EnumTypes enum_type)
+{
+    const EnumNameTable* table = EnumRegistry::find(enum_type);
+    if (table == nullptr) {
+        throw_unknown_enum(enum_type);
+    }
+    return table->type_name;
+}
+
+}
@@ -1,7 +1,10 @@
+module;
+
+#include "magic_enum.hpp"
+
 export module ErrorHandling:Enums;
 
 import std;
-import "magic_enum.hpp";
 
 namespace cppline::errors
 {
@@ -19,36 +22,8 @@ export enum class EnumTypes
     Message,
 };
 
-export using EnumsMap = std::map<EnumTypes, uint32_t>;
-
-export template <EnumType Enum>
-EnumTypes enum_type_helper(Enum enumerator);
-
-export template <EnumType Enum>
-EnumTypes enum_type(Enum enumerator) {
-    return enum_type_helper(enumerator);
-}
-
-export template <EnumType... Enums>
-EnumsMap create_enum_map(Enums... enumValues)
-{
-    EnumsMap map;
-    create_enum_map_helper(map, std::forward<Enums>(enumValues)...);
-    return map;
-}
-
-export template <EnumType Enum, EnumType... Enums>
-void create_enum_map_helper(EnumsMap& map, Enum value, Enums... enumValues)
-{
-    map[enum_type(value)] = static_cast<uint32_t>(value);
-    create_enum_map_helper(map, std::forward<Enums>(enumValues)...);
-}
-
-export template <EnumType Enum>
-void create_enum_map_helper(EnumsMap& map, Enum value)
-{
-    map[enum_type(value)] = static_cast<uint32_t>(value);
-}
+// Ids of the EnumTypes enumerators are the same in every process, registered enums get the ids after them
+export constexpr size_t BUILTIN_ENUM_TYPES = magic_enum::enum_count<EnumTypes>();
 
 export enum class Status {
     Success,
@@ -63,7 +38,8 @@ export enum class Status {
     UnknownEnum,
     UnknownError,
     OptionAlreadyDefined,
-    OptionNotSet
+    OptionNotSet,
+    FileError,
 };
 
 export enum class Param {
@@ -80,8 +56,210 @@ export enum class Param {
     EnumValue,
     EnumType,
     Index,
+    FilePath,
+};
+
+// Enum types a Context can hold: the EnumTypes enumerators and enums registered with EnumRegistry
+export constexpr size_t MAX_ENUM_TYPES = 16;
+
+template <EnumType Enum>
+consteval bool is_dense_enum()
+{
+    constexpr auto values = magic_enum::enum_values<Enum>();
+    for (size_t index = 0; index < values.size(); ++index) {
+        if (static_cast<size_t>(values[index]) != index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Map keyed by a dense enum (enumerators 0..N-1): one inline slot per enumerator and a presence bitmask.
+// Inserting and looking up never allocates, iteration visits the present keys in enumerator order.
+// A larger Capacity also holds values past the last enumerator, like ids of registered enum types.
+export template <EnumType Enum, typename T, size_t Capacity = magic_enum::enum_count<Enum>()>
+class EnumIndexedMap final
+{
+public:
+    static constexpr size_t CAPACITY = Capacity;
+    static_assert(is_dense_enum<Enum>(), "EnumIndexedMap needs an enum with enumerators 0..N-1");
+    static_assert(CAPACITY >= magic_enum::enum_count<Enum>());
+    static_assert(CAPACITY <= 64, "The presence mask is a 64 bit integer");
+
+    class Iterator final
+    {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using value_type = std::pair<Enum, T>;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        constexpr Iterator(const EnumIndexedMap* map, const size_t index) :
+            m_map(map),
+            m_index(map->next_present(index))
+        {
+        }
+
+        constexpr value_type operator*() const { return { static_cast<Enum>(m_index), m_map->m_values[m_index] }; }
+
+        constexpr Iterator& operator++()
+        {
+            m_index = m_map->next_present(m_index + 1);
+            return *this;
+        }
+
+        constexpr Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        constexpr bool operator==(const Iterator& other) const noexcept { return m_index == other.m_index; }
+
+    private:
+        const EnumIndexedMap* m_map = nullptr;
+        size_t m_index = CAPACITY;
+    };
+
+    constexpr bool contains(const Enum key) const noexcept
+    {
+        return static_cast<size_t>(key) < CAPACITY && (m_present & bit(static_cast<size_t>(key))) != 0;
+    }
+    constexpr bool empty() const noexcept { return m_present == 0; }
+    constexpr size_t size() const noexcept { return static_cast<size_t>(std::popcount(m_present)); }
+
+    // Returns nullptr if the key is not present
+    constexpr const T* find(const Enum key) const noexcept
+    {
+        return contains(key) ? &m_values[static_cast<size_t>(key)] : nullptr;
+    }
+
+    // Keeps the existing value if the key is already present, like std::map::emplace
+    constexpr bool try_emplace(const Enum key, T value)
+    {
+        if (contains(key)) {
+            return false;
+        }
+        insert_or_assign(key, std::move(value));
+        return true;
+    }
+
+    constexpr void insert_or_assign(const Enum key, T value)
+    {
+        m_values[static_cast<size_t>(key)] = std::move(value);
+        m_present |= bit(static_cast<size_t>(key));
+    }
+
+    constexpr Iterator begin() const { return Iterator(this, 0); }
+    constexpr Iterator end() const { return Iterator(this, CAPACITY); }
+
+private:
+    static constexpr std::uint64_t bit(const size_t index) noexcept { return std::uint64_t{ 1 } << index; }
+
+    constexpr size_t next_present(const size_t index) const noexcept
+    {
+        const std::uint64_t remaining = index < CAPACITY ? m_present >> index : 0;
+        return remaining == 0 ? CAPACITY : index + static_cast<size_t>(std::countr_zero(remaining));
+    }
+
+    std::array<T, CAPACITY> m_values{};
+    std::uint64_t m_present = 0;
+};
+
+// Enum value of each enum type, keyed by EnumTypes. A fixed array, so building one never allocates.
+export using EnumsMap = EnumIndexedMap<EnumTypes, uint32_t, MAX_ENUM_TYPES>;
+
+// Names of the enumerators of a dense enum, indexed by value
+template <EnumType Enum>
+inline constexpr auto ENUM_NAMES = magic_enum::enum_names<Enum>();
+
+// Name of an enumerator, an empty view for values that are not one. Never allocates.
+export template <EnumType Enum>
+constexpr std::string_view enum_name(const Enum value) noexcept
+{
+    static_assert(is_dense_enum<Enum>(), "Enum name tables need an enum with enumerators 0..N-1");
+    const auto index = static_cast<size_t>(value);
+    return index < ENUM_NAMES<Enum>.size() ? ENUM_NAMES<Enum>[index] : std::string_view{};
+}
+
+// Names of one enum type, for when only its EnumTypes id and a value are known
+export struct EnumNameTable {
+    std::string_view type_name;
+    std::span<const std::string_view> names; // Indexed by enumerator value
+};
+
+// An enum value known only by its names, e.g. one of a type registered in another process
+export struct NamedEnum {
+    std::string type_name;
+    std::string value_name;
 };
 
-std::string enum_to_string(EnumTypes enum_type, uint32_t enum_value);
+// Name tables of every enum type that can be stored in a Context, indexed by EnumTypes.
+// The EnumTypes enumerators are built in, other enums get the next free id the first time they are used,
+// register them at startup to keep their ids the same from run to run.
+export class EnumRegistry final
+{
+public:
+    // Throws if MAX_ENUM_TYPES enum types are registered already
+    template <EnumType Enum>
+    static EnumTypes register_enum()
+    {
+        static_assert(is_dense_enum<Enum>(), "Registered enums need enumerators 0..N-1");
+        static const EnumTypes id = add(EnumNameTable{ magic_enum::enum_type_name<Enum>(), ENUM_NAMES<Enum> });
+        return id;
+    }
+
+    // nullptr for ids nothing was registered for
+    static const EnumNameTable* find(EnumTypes enum_type) noexcept;
+    static size_t size() noexcept;
+
+private:
+    static EnumTypes add(const EnumNameTable& table);
+
+    static std::array<EnumNameTable, MAX_ENUM_TYPES> s_tables;
+    static std::atomic<size_t> s_size; // Tables below it are complete and never change
+    static std::mutex s_add_mutex;
+
+public:
+    // Static class:
+    EnumRegistry() = delete;
+    ~EnumRegistry() = delete;
+    EnumRegistry(const EnumRegistry&) = delete;
+    EnumRegistry(EnumRegistry&&) = delete;
+    EnumRegistry& operator=(const EnumRegistry&) = delete;
+    EnumRegistry& operator=(EnumRegistry&&) = delete;
+};
+
+// Constant for the built-in enums, other enums are looked up in (and added to) the EnumRegistry
+export template <EnumType Enum>
+constexpr EnumTypes enum_type(Enum) {
+    if constexpr (std::same_as<Enum, EnumTypes>) {
+        return EnumTypes::EnumTypes;
+    }
+    else if constexpr (std::same_as<Enum, Status>) {
+        return EnumTypes::Status;
+    }
+    else if constexpr (std::same_as<Enum, Message>) {
+        return EnumTypes::Message;
+    }
+    else {
+        return EnumRegistry::register_enum<Enum>();
+    }
+}
+
+// A later value of the same enum type replaces an earlier one.
+// Built at compile time when all values are constants of built-in enums.
+export template <EnumType... Enums>
+constexpr EnumsMap create_enum_map(const Enums... enum_values)
+{
+    EnumsMap map;
+    (map.insert_or_assign(enum_type(enum_values), static_cast<uint32_t>(enum_values)), ...);
+    return map;
+}
+
+// Both throw for enum types that are not registered
+export std::string_view enum_to_string(EnumTypes enum_type, uint32_t enum_value);
+export std::string_view enum_type_name(EnumTypes enum_type);
 
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+module ErrorHandling;
+
+import std;
+import :Context;
+import :Enums;
+import :Exception;
+
+namespace cppline::errors
+{
+Error::Error(const Status status, Context context, const ErrorLocation location) :
+    Error(status, std::move(context), location, StacktracePolicy::capture(status, location))
+{
+}
+
+Error::Error(const Status status, Context context, const ErrorLocation location, std::optional<std::stacktrace> stacktrace) :
+    m_status(static_cast<std::uint16_t>(status)),
+    m_line(location.line),
+    m_payload{ location.file_name }
+{
+    // The column is only kept for errors that need the Exception anyway
+    if (!context.empty() || stacktrace.has_value()) {
+        m_payload.exception = new Exception(status, std::move(context), location, std::move(stacktrace));
+        m_flags = HAS_EXCEPTION;
+    }
+}
+
+Error::Error(Exception exception) :
+    m_status(static_cast<std::uint16_t>(exception.get_error())),
+    m_flags(HAS_EXCEPTION),
+    m_line(exception.get_location().line)
+{
+    m_payload.exception = new Exception(std::move(exception));
+}
+
+Error::~Error()
+{
+    reset();
+}
+
+Error::Error(const Error& other) :
+    m_status(other.m_status),
+    m_flags(other.m_flags),
+    m_line(other.m_line),
+    m_payload(other.m_payload)
+{
+    if (has_exception()) {
+        m_payload.exception = new Exception(*other.m_payload.exception);
+    }
+}
+
+Error::Error(Error&& other) noexcept :
+    m_status(other.m_status),
+    m_flags(other.m_flags),
+    m_line(other.m_line),
+    m_payload(other.m_payload)
+{
+    other.m_flags = 0;
+    other.m_payload.file_name = "";
+}
+
+Error& Error::operator=(const Error& other)
+{
+    if (this != &other) {
+        *this = Error(other);
+    }
+    return *this;
+}
+
+Error& Error::operator=(Error&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        m_status = other.m_status;
+        m_flags = std::exchange(other.m_flags, std::uint16_t{ 0 });
+        m_line = other.m_line;
+        m_payload = std::exchange(other.m_payload, Payload{ "" });
+    }
+    return *this;
+}
+
+Status Error::get_error() const noexcept
+{
+    return static_cast<Status>(m_status);
+}
+
+ErrorLocation Error::get_location() const noexcept
+{
+    if (has_exception()) {
+        return m_payload.exception->get_location();
+    }
+    return ErrorLocation(m_payload.file_name, m_line);
+}
+
+Context Error::get_context() const
+{
+    if (has_exception()) {
+        return m_payload.exception->get_context();
+    }
+
+    Context context(get_error());
+    context << location_to_context(get_location());
+    return context;
+}
+
+const Context* Error::get_cached_context() const
+{
+    return has_exception() ? &m_payload.exception->get_context() : nullptr;
+}
+
+std::shared_ptr<const Context> Error::share_context() const
+{
+    return has_exception() ? m_payload.exception->share_context() : nullptr;
+}
+
+const std::optional<std::stacktrace>& Error::get_stacktrace() const
+{
+    static const std::optional<std::stacktrace> no_stacktrace;
+    return has_exception() ? m_payload.exception->get_stacktrace() : no_stacktrace;
+}
+
+std::optional<std::stacktrace> Error::take_stacktrace() &&
+{
+    return has_exception() ? std::move(*m_payload.exception).take_stacktrace() : std::nullopt;
+}
+
+void Error::throw_self() const&
+{
+    to_exception().throw_self();
+}
+
+void Error::throw_self() &&
+{
+    std::move(*this).to_exception().throw_self();
+}
+
+Exception Error::to_exception() const&
+{
+    if (has_exception()) {
+        return *m_payload.exception;
+    }
+    return Exception(get_error(), Context{}, get_location(), std::nullopt);
+}
+
+Exception Error::to_exception() &&
+{
+    if (has_exception()) {
+        return std::move(*m_payload.exception);
+    }
+    return Exception(get_error(), Context{}, get_location(), std::nullopt);
+}
+
+bool Error::has_exception() const noexcept
+{
+    return (m_flags & HAS_EXCEPTION) != 0;
+}
+
+void Error::reset() noexcept
+{
+    if (has_exception()) {
+        delete m_payload.exception;
+        m_flags = 0;
+        m_payload.file_name = "";
+    }
+}
+
+} // namespace cppline::errors
@@ -0,0 +1,69 @@
+export module ErrorHandling:Error;
+
+import std;
+import :Context;
+import :Enums;
+import :Exception;
+
+export namespace cppline::errors {
+
+// Error type of Expected, small enough that returning an Expected stays cheap.
+// A plain error keeps its status, file name and line inline. Context, stacktrace and column
+// live in an Exception that is only allocated when the error carries them.
+class Error final
+{
+public:
+    // Captures a stacktrace if the StacktracePolicy asks for one
+    explicit Error(Status status,
+                   Context context = Context{},
+                   ErrorLocation location = std::source_location::current());
+    explicit Error(Status status,
+                   Context context,
+                   ErrorLocation location,
+                   std::optional<std::stacktrace> stacktrace);
+    explicit Error(Exception exception);
+    ~Error();
+
+    Error(const Error& other);
+    Error(Error&& other) noexcept;
+    Error& operator=(const Error& other);
+    Error& operator=(Error&& other) noexcept;
+
+    Status get_error() const noexcept;
+    ErrorLocation get_location() const noexcept;
+    // Status, location and context merged like Exception::get_context. Returned by value,
+    // a plain error has no Exception to cache it in and builds it on every call.
+    Context get_context() const;
+    // The merged context cached in the Exception the error holds, returned without copying it.
+    // nullptr for a plain error, which has nowhere to cache it.
+    const Context* get_cached_context() const;
+    std::shared_ptr<const Context> share_context() const; // Also nullptr for a plain error
+    const std::optional<std::stacktrace>& get_stacktrace() const;
+    std::optional<std::stacktrace> take_stacktrace() &&;
+    [[noreturn]] void throw_self() const&; // Throws a copy of the full Exception
+    [[noreturn]] void throw_self() &&;     // Throws the full Exception by moving it out
+
+    // The full exception: a copy of the one the error holds, or a new one for a plain error
+    Exception to_exception() const&;
+    Exception to_exception() &&;
+
+private:
+    static constexpr std::uint16_t HAS_EXCEPTION = 1;
+
+    bool has_exception() const noexcept;
+    void reset() noexcept;
+
+    union Payload {
+        const char* file_name;
+        Exception* exception;
+    };
+
+    std::uint16_t m_status;
+    std::uint16_t m_flags = 0;
+    std::uint32_t m_line;
+    Payload m_payload;
+};
+
+static_assert(sizeof(Error) == 16, "Error should stay two words");
+
+} // namespace cppline::errors
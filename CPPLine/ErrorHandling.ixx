@@ -4,4 +4,9 @@ export import :Logger;
 export import :Context;
 export import :Enums;
 export import :Exception;
-export import :Expected;
\ No newline at end of file
+export import :Error;
+export import :Expected;
+export import :Stacktrace;
+export import :AsyncLogger;
+export import :LogSinks;
+export import :BinaryLog;
\ No newline at end of file
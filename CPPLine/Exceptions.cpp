@@ -1,3 +1,7 @@
+module;
+
+#include "magic_enum.hpp"
+
 module ErrorHandling;
 
 import std;
@@ -6,43 +10,250 @@ import :Enums;
 
 namespace cppline::errors
 {
+namespace {
+
+struct RateWindow {
+    std::chrono::steady_clock::time_point start;
+    std::uint32_t count = 0;
+};
+
+using LocationKey = std::pair<const char*, std::uint_least32_t>; // File name and line
+
+struct LocationHash {
+    size_t operator()(const LocationKey& key) const noexcept
+    {
+        return std::hash<const char*>{}(key.first) ^ (static_cast<size_t>(key.second) * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+static_assert(magic_enum::enum_count<Status>() <= 64, "The status allow list is a 64 bit mask");
+
+std::atomic<StacktraceMode> g_mode = CONSTEXPR_IS_DEBUG ? StacktraceMode::Always : StacktraceMode::Off;
+std::atomic<std::uint64_t> g_allowed_statuses = 0;
+std::atomic<std::uint32_t> g_sample_one_in = 1;
+std::atomic<std::uint32_t> g_sample_generation = 0; // Bumped by set_sampling so every thread restarts its countdown
+std::atomic<std::uint32_t> g_rate_per_location = 1;
+std::atomic<std::chrono::nanoseconds::rep> g_rate_period = 0;
+
+std::mutex g_rate_mutex;
+std::unordered_map<LocationKey, RateWindow, LocationHash> g_rate_windows;
+
+} // namespace
+
+StacktraceMode StacktracePolicy::get_mode()
+{
+    return g_mode.load(std::memory_order_relaxed);
+}
+
+void StacktracePolicy::set_off()
+{
+    g_mode.store(StacktraceMode::Off, std::memory_order_relaxed);
+}
+
+void StacktracePolicy::set_always()
+{
+    g_mode.store(StacktraceMode::Always, std::memory_order_relaxed);
+}
+
+void StacktracePolicy::set_status_allow_list(const std::initializer_list<Status> statuses)
+{
+    std::uint64_t mask = 0;
+    for (const Status status : statuses) {
+        mask |= std::uint64_t{ 1 } << static_cast<std::uint32_t>(status);
+    }
+    g_allowed_statuses.store(mask, std::memory_order_relaxed);
+    g_mode.store(StacktraceMode::StatusAllowList, std::memory_order_relaxed);
+}
+
+void StacktracePolicy::set_sampling(const std::uint32_t one_in)
+{
+    g_sample_one_in.store(std::max<std::uint32_t>(one_in, 1), std::memory_order_relaxed);
+    g_sample_generation.fetch_add(1, std::memory_order_relaxed);
+    g_mode.store(StacktraceMode::Sampling, std::memory_order_relaxed);
+}
+
+void StacktracePolicy::set_rate_limit(const std::uint32_t per_location, const std::chrono::nanoseconds period)
+{
+    {
+        std::scoped_lock lock(g_rate_mutex);
+        g_rate_windows.clear();
+    }
+    g_rate_per_location.store(per_location, std::memory_order_relaxed);
+    g_rate_period.store(period.count(), std::memory_order_relaxed);
+    g_mode.store(StacktraceMode::RateLimit, std::memory_order_relaxed);
+}
+
+bool StacktracePolicy::should_capture(const Status status, const ErrorLocation& location)
+{
+    switch (get_mode()) {
+    case StacktraceMode::Off:
+        return false;
+    case StacktraceMode::Always:
+        return true;
+    case StacktraceMode::StatusAllowList:
+        return is_status_allowed(status);
+    case StacktraceMode::Sampling:
+        return take_sample();
+    case StacktraceMode::RateLimit:
+        return take_rate_limited(location);
+    default:
+        return false;
+    }
+}
+
+std::optional<std::stacktrace> StacktracePolicy::capture(const Status status, const ErrorLocation& location)
+{
+    if (!should_capture(status, location)) {
+        return std::nullopt;
+    }
+    return std::stacktrace::current(1); // Leave out this frame
+}
+
+bool StacktracePolicy::is_status_allowed(const Status status)
+{
+    const std::uint64_t bit = std::uint64_t{ 1 } << static_cast<std::uint32_t>(status);
+    return (g_allowed_statuses.load(std::memory_order_relaxed) & bit) != 0;
+}
+
+bool StacktracePolicy::take_sample()
+{
+    // Per thread countdown, a hot failing loop on one thread does not contend with the others
+    thread_local std::uint32_t countdown = 0;
+    thread_local std::uint32_t generation = 0;
+    const std::uint32_t current_generation = g_sample_generation.load(std::memory_order_relaxed);
+    if (countdown == 0 || generation != current_generation) {
+        countdown = g_sample_one_in.load(std::memory_order_relaxed);
+        generation = current_generation;
+    }
+    return --countdown == 0;
+}
+
+bool StacktracePolicy::take_rate_limited(const ErrorLocation& location)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::nanoseconds period(g_rate_period.load(std::memory_order_relaxed));
+
+    std::scoped_lock lock(g_rate_mutex);
+    RateWindow& window = g_rate_windows[LocationKey{ location.file_name, location.line }];
+    if (window.count == 0 || now - window.start >= period) {
+        window.start = now;
+        window.count = 0;
+    }
+    if (window.count >= g_rate_per_location.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    ++window.count;
+    return true;
+}
+
+Exception::Exception(Status status,
+                     Context context,
+                     ErrorLocation location) :
+    Exception(status, std::move(context), location, StacktracePolicy::capture(status, location))
+{
+}
+
 Exception::Exception(Status status,
                      Context context,
-                     std::source_location location,
+                     ErrorLocation location,
                      std::optional<std::stacktrace> stacktrace) :
     m_status(status),
     m_context(std::move(context)),
-    m_location(std::move(location)),
+    m_location(location),
     m_stacktrace(std::move(stacktrace)) {}
 
+Exception::Exception(const Exception& other) :
+    m_status(other.m_status),
+    m_context(other.m_context),
+    m_location(other.m_location),
+    m_stacktrace(other.m_stacktrace),
+    m_full_context(other.shared_full_context()),
+    m_full_context_ready(m_full_context.get()) {}
+
+Exception::Exception(Exception&& other) noexcept :
+    m_status(other.m_status),
+    m_context(std::move(other.m_context)),
+    m_location(other.m_location),
+    m_stacktrace(std::move(other.m_stacktrace)),
+    m_full_context(std::move(other.m_full_context)),
+    m_full_context_ready(other.m_full_context_ready.exchange(nullptr, std::memory_order_relaxed)) {}
+
+Exception& Exception::operator=(const Exception& other)
+{
+    if (this != &other) {
+        *this = Exception(other);
+    }
+    return *this;
+}
+
+Exception& Exception::operator=(Exception&& other) noexcept
+{
+    if (this != &other) {
+        m_status = other.m_status;
+        m_context = std::move(other.m_context);
+        m_location = other.m_location;
+        m_stacktrace = std::move(other.m_stacktrace);
+        m_full_context = std::move(other.m_full_context);
+        m_full_context_ready.store(other.m_full_context_ready.exchange(nullptr, std::memory_order_relaxed),
+                                   std::memory_order_relaxed);
+    }
+    return *this;
+}
+
 Status Exception::get_error() const
 {
     return m_status;
 }
-Context Exception::get_context() const
+const Context& Exception::get_context() const
 {
-    auto exception_context = Context(m_status)
-        << location_to_context(get_location());
-
-    if (const std::optional<std::stacktrace> stack_trace = get_stacktrace(); stack_trace.has_value())
-    {
-        exception_context << stacktrace_to_context(stack_trace.value());
+    if (const Context* full_context = m_full_context_ready.load(std::memory_order_acquire)) {
+        return *full_context; // Never replaced once built, except by assigning to the Exception
     }
 
-    return exception_context << m_context;
+    std::scoped_lock lock(m_full_context_mutex);
+    if (!m_full_context) {
+        // The stacktrace is left out, it is only symbolized when a log renders it
+        auto full_context = std::make_shared<Context>(m_status);
+        *full_context << location_to_context(get_location()) << m_context;
+        m_full_context = std::move(full_context);
+        m_full_context_ready.store(m_full_context.get(), std::memory_order_release);
+    }
+    return *m_full_context;
 }
-void errors::Exception::throw_self() const
+std::shared_ptr<const Context> Exception::share_context() const
+{
+    get_context();
+    return m_full_context; // Built and published by get_context, so no lock is needed
+}
+std::shared_ptr<const Context> Exception::shared_full_context() const
+{
+    if (m_full_context_ready.load(std::memory_order_acquire) != nullptr) {
+        return m_full_context;
+    }
+    std::scoped_lock lock(m_full_context_mutex);
+    return m_full_context;
+}
+void errors::Exception::throw_self() const&
 {
     throw* this;
 }
-std::source_location Exception::get_location() const
+void errors::Exception::throw_self() &&
+{
+    throw std::move(*this);
+}
+const ErrorLocation& Exception::get_location() const
 {
     return m_location;
 }
 
-std::optional<std::stacktrace> Exception::get_stacktrace() const
+const std::optional<std::stacktrace>& Exception::get_stacktrace() const
 {
     return m_stacktrace;
 }
 
+std::optional<std::stacktrace> Exception::take_stacktrace() &&
+{
+    return std::exchange(m_stacktrace, std::nullopt);
+}
+
 } // namespace cppline
\ No newline at end of file
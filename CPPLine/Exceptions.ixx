@@ -12,33 +12,88 @@ constexpr bool CONSTEXPR_IS_DEBUG = true;
 constexpr bool CONSTEXPR_IS_DEBUG = false;
 #endif
 
+enum class StacktraceMode {
+    Off,
+    Always,
+    StatusAllowList, // Only errors with one of the allowed statuses
+    Sampling,        // One in every N errors, counted per thread from the last set_sampling
+    RateLimit,       // At most N errors per period from each source location
+};
+
+// Decides which errors capture a stacktrace, consulted by Exception and make_unexpected.
+// Defaults to Always in debug builds and Off in release builds, settings apply to all threads.
+class StacktracePolicy final
+{
+public:
+    static StacktraceMode get_mode();
+
+    static void set_off();
+    static void set_always();
+    static void set_status_allow_list(std::initializer_list<Status> statuses);
+    static void set_sampling(std::uint32_t one_in);
+    static void set_rate_limit(std::uint32_t per_location, std::chrono::nanoseconds period);
+
+    static bool should_capture(Status status, const ErrorLocation& location);
+
+    // Returns a stacktrace of the caller if the policy asks for one
+    static std::optional<std::stacktrace> capture(Status status, const ErrorLocation& location);
+
+private:
+    static bool is_status_allowed(Status status);
+    static bool take_sample();
+    static bool take_rate_limited(const ErrorLocation& location);
+
+public:
+    // Static class:
+    StacktracePolicy() = delete;
+    ~StacktracePolicy() = delete;
+    StacktracePolicy(const StacktracePolicy&) = delete;
+    StacktracePolicy(StacktracePolicy&&) = delete;
+    StacktracePolicy& operator=(const StacktracePolicy&) = delete;
+    StacktracePolicy& operator=(StacktracePolicy&&) = delete;
+};
+
 class Exception final
 {
 public:
+    // Captures a stacktrace if the StacktracePolicy asks for one
+    explicit Exception(Status status,
+                       Context context = Context{},
+                       ErrorLocation location = std::source_location::current());
     explicit Exception(Status status,
-                       Context context = StringContext{},
-                       std::source_location location = std::source_location::current(),
-                       std::optional<std::stacktrace> stacktrace =
-                       CONSTEXPR_IS_DEBUG ? std::make_optional(std::stacktrace::current()) : std::nullopt);
+                       Context context,
+                       ErrorLocation location,
+                       std::optional<std::stacktrace> stacktrace);
     ~Exception() = default;
 
-    Context get_context() const;
-    void throw_self() const; // To allow ExceptionPtr to throw DerivedException.
+    // Status, location and the attached context merged into one, built on first use and cached.
+    // Safe to call from several threads on the same Exception, only the first call takes a lock.
+    const Context& get_context() const;
+    std::shared_ptr<const Context> share_context() const; // The context of get_context, for holders that outlive the Exception
+    [[noreturn]] void throw_self() const&; // To allow ExceptionPtr to throw DerivedException.
+    [[noreturn]] void throw_self() &&;     // Throws by moving, the context and stacktrace are not copied
 
     Status get_error() const;
-    std::source_location get_location() const;
-    std::optional<std::stacktrace> get_stacktrace() const;
+    const ErrorLocation& get_location() const;
+    const std::optional<std::stacktrace>& get_stacktrace() const;
+    std::optional<std::stacktrace> take_stacktrace() &&; // Leaves the Exception without a stacktrace
 
-    Exception(const Exception&) = default;             // Copy Ctor
-    Exception(Exception&&) = default;                  // Move Ctor
-    Exception& operator= (const Exception&) = default; // Copy Assignment Operator
-    Exception& operator= (Exception&&) = default;      // Move Assignment Operator
+    Exception(const Exception& other);                 // Copy Ctor
+    Exception(Exception&& other) noexcept;             // Move Ctor
+    Exception& operator= (const Exception& other);     // Copy Assignment Operator
+    Exception& operator= (Exception&& other) noexcept; // Move Assignment Operator
 
 private:
+    std::shared_ptr<const Context> shared_full_context() const;
+
     Status m_status;
     Context m_context;
-    std::source_location m_location;
+    ErrorLocation m_location;
     std::optional<std::stacktrace> m_stacktrace;
+    mutable std::mutex m_full_context_mutex; // Guards building m_full_context from const get_context calls
+    mutable std::shared_ptr<const Context> m_full_context; // Immutable once built, so copies can share it
+    // Published with release once m_full_context is built, readers that see it need no lock
+    mutable std::atomic<const Context*> m_full_context_ready = nullptr;
 };
 
 } // namespace cppline::errors
\ No newline at end of file
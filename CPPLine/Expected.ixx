@@ -2,11 +2,14 @@ export module ErrorHandling:Expected;
 
 import std;
 import :Exception;
+import :Error;
 
 export namespace cppline::errors {
 
-using ExpectedVoid = std::expected<void, Exception>;
-using ExpectedString = std::expected<std::string, Exception>;
+using ExpectedVoid = std::expected<void, Error>;
+using ExpectedString = std::expected<std::string, Error>;
+
+static_assert(sizeof(ExpectedVoid) <= 2 * sizeof(Error), "Returning an ExpectedVoid should stay cheap");
 
 ExpectedVoid success()
 {
@@ -14,19 +17,32 @@ ExpectedVoid success()
 }
 
 template <typename T >
-using Expected = std::expected<T, Exception>;
+using Expected = std::expected<T, Error>;
+
+// Captures a stacktrace if the StacktracePolicy asks for one
+inline std::unexpected<Error> make_unexpected(const Status status,
+                                              Context context = Context{},
+                                              const std::source_location& location = std::source_location::current())
+{
+    return std::unexpected(Error(status, std::move(context), location));
+}
 
-inline std::unexpected<Exception> make_unexpected(const Status status,
-                                                  Context context = StringContext{},
-                                                  const std::source_location& location = std::source_location::current(),
-                                                  const std::optional<std::stacktrace>& stacktrace = CONSTEXPR_IS_DEBUG ? std::make_optional(std::stacktrace::current()) : std::nullopt)
+inline std::unexpected<Error> make_unexpected(const Status status,
+                                              Context context,
+                                              const std::source_location& location,
+                                              std::optional<std::stacktrace> stacktrace)
 {
-    return std::unexpected(Exception(status, std::move(context), location, stacktrace));
+    return std::unexpected(Error(status, std::move(context), location, std::move(stacktrace)));
 }
 
-inline std::unexpected<Exception> make_unexpected(Exception&& exception)
+inline std::unexpected<Error> make_unexpected(Error&& error)
 {
-    return std::unexpected(std::move(exception));
+    return std::unexpected(std::move(error));
+}
+
+inline std::unexpected<Error> make_unexpected(Exception&& exception)
+{
+    return std::unexpected(Error(std::move(exception)));
 }
 
 template <typename T >
@@ -38,5 +54,19 @@ void throw_on_error(const Expected<T>& expected)
     }
 }
 
+// Consumes the result: the error is thrown by moving it, the value is moved out to the caller
+template <typename T >
+T throw_on_error(Expected<T>&& expected)
+{
+    if (!expected.has_value())
+    {
+        std::move(expected).error().throw_self();
+    }
+
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(expected).value();
+    }
+}
+
 } // namespace cppline::errors
 
@@ -0,0 +1,292 @@
+module;
+
+#include "Macros.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+module ErrorHandling;
+
+import std;
+
+namespace cppline::errors
+{
+namespace {
+
+Context file_context(const std::filesystem::path& path)
+{
+    return Context{ Param::FilePath, path.string() };
+}
+
+} // namespace
+
+void ConsoleSink::write(const std::string_view text)
+{
+    std::cout << text;
+    std::cout.flush();
+}
+
+void ConsoleSink::flush()
+{
+    std::cout.flush();
+}
+
+Expected<std::shared_ptr<BufferedFileSink>> BufferedFileSink::try_open(const std::filesystem::path& path, const size_t buffer_size)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return make_unexpected(Status::FileError, file_context(path));
+    }
+    return std::make_shared<BufferedFileSink>(std::move(file), buffer_size);
+}
+
+std::shared_ptr<BufferedFileSink> BufferedFileSink::open(const std::filesystem::path& path, const size_t buffer_size)
+{
+    return throw_on_error(try_open(path, buffer_size));
+}
+
+BufferedFileSink::BufferedFileSink(std::ofstream file, const size_t buffer_size) :
+    m_file(std::move(file)),
+    m_buffer_size(buffer_size)
+{
+    m_buffer.reserve(buffer_size);
+}
+
+BufferedFileSink::~BufferedFileSink()
+{
+    flush();
+}
+
+void BufferedFileSink::write(const std::string_view text)
+{
+    if (m_buffer.size() + text.size() > m_buffer_size) {
+        write_buffer();
+    }
+
+    if (text.size() >= m_buffer_size) {
+        m_file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    else {
+        m_buffer.append(text);
+    }
+}
+
+void BufferedFileSink::flush()
+{
+    write_buffer();
+    m_file.flush();
+}
+
+void BufferedFileSink::write_buffer()
+{
+    m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
+
+Expected<std::shared_ptr<MemoryMappedFileSink>> MemoryMappedFileSink::try_open(const std::filesystem::path& path,
+                                                                               const size_t file_size,
+                                                                               const size_t max_rotated_files)
+{
+    auto sink = std::make_shared<MemoryMappedFileSink>(path, file_size, max_rotated_files);
+    return_on_error(sink->map());
+    return sink;
+}
+
+std::shared_ptr<MemoryMappedFileSink> MemoryMappedFileSink::open(const std::filesystem::path& path,
+                                                                 const size_t file_size,
+                                                                 const size_t max_rotated_files)
+{
+    return throw_on_error(try_open(path, file_size, max_rotated_files));
+}
+
+MemoryMappedFileSink::MemoryMappedFileSink(std::filesystem::path path, const size_t file_size, const size_t max_rotated_files) :
+    m_path(std::move(path)),
+    m_file_size(std::max<size_t>(file_size, 1)),
+    m_max_rotated_files(max_rotated_files)
+{
+}
+
+MemoryMappedFileSink::~MemoryMappedFileSink()
+{
+    unmap();
+}
+
+void MemoryMappedFileSink::write(std::string_view text)
+{
+    // A failed rotation leaves nothing mapped, so every write tries to map the file again
+    if (m_mapped.view == nullptr && !map().has_value()) {
+        m_dropped_bytes.fetch_add(text.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    // Logger writes whole records, so starting a new file instead of filling the current one keeps binary
+    // records in one file. Only text longer than a whole file is still split.
+    if (m_offset != 0 && text.size() > m_file_size - m_offset && !rotate().has_value()) {
+        m_dropped_bytes.fetch_add(text.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    while (!text.empty()) {
+        const size_t length = std::min(text.size(), m_file_size - m_offset);
+        std::memcpy(m_mapped.view + m_offset, text.data(), length);
+        m_offset += length;
+        text.remove_prefix(length);
+
+        if (m_offset == m_file_size && !rotate().has_value()) {
+            m_dropped_bytes.fetch_add(text.size(), std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+size_t MemoryMappedFileSink::dropped_bytes() const noexcept
+{
+    return m_dropped_bytes.load(std::memory_order_relaxed);
+}
+
+void MemoryMappedFileSink::flush()
+{
+    if (m_mapped.view == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    FlushViewOfFile(m_mapped.view, m_offset);
+#else
+    msync(m_mapped.view, m_file_size, MS_ASYNC);
+#endif
+}
+
+ExpectedVoid MemoryMappedFileSink::map()
+{
+    m_offset = 0;
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(m_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                                    CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return make_unexpected(Status::FileError, file_context(m_path));
+    }
+
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(m_file_size);
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    void* view = mapping == nullptr ? nullptr : MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, m_file_size);
+    if (view == nullptr) {
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return make_unexpected(Status::FileError, file_context(m_path));
+    }
+
+    m_mapped = MappedFile{ reinterpret_cast<std::intptr_t>(file), reinterpret_cast<std::intptr_t>(mapping), static_cast<char*>(view) };
+#else
+    const int file = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        return make_unexpected(Status::FileError, file_context(m_path));
+    }
+
+    void* view = ftruncate(file, static_cast<off_t>(m_file_size)) == 0
+        ? mmap(nullptr, m_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0)
+        : MAP_FAILED;
+    if (view == MAP_FAILED) {
+        ::close(file);
+        return make_unexpected(Status::FileError, file_context(m_path));
+    }
+
+    m_mapped = MappedFile{ file, 0, static_cast<char*>(view) };
+#endif
+    return success();
+}
+
+void MemoryMappedFileSink::unmap()
+{
+    if (m_mapped.view == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    const auto file = reinterpret_cast<HANDLE>(m_mapped.file);
+    UnmapViewOfFile(m_mapped.view);
+    CloseHandle(reinterpret_cast<HANDLE>(m_mapped.mapping));
+
+    // Cut the file down to the text written, the rest of the mapping is zeros
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(m_offset);
+    SetFilePointerEx(file, end, nullptr, FILE_BEGIN);
+    SetEndOfFile(file);
+    CloseHandle(file);
+#else
+    const auto file = static_cast<int>(m_mapped.file);
+    munmap(m_mapped.view, m_file_size);
+    // Cut the file down to the text written, the rest of the mapping is zeros
+    [[maybe_unused]] const int result = ftruncate(file, static_cast<off_t>(m_offset));
+    ::close(file);
+#endif
+    m_mapped = MappedFile{};
+}
+
+ExpectedVoid MemoryMappedFileSink::rotate()
+{
+    unmap();
+
+    auto rotated_path = [this](const size_t index) {
+        std::filesystem::path path = m_path;
+        path += std::format(".{}", index);
+        return path;
+    };
+
+    std::error_code error;
+    if (m_max_rotated_files == 0) {
+        std::filesystem::remove(m_path, error);
+    }
+    else {
+        std::filesystem::remove(rotated_path(m_max_rotated_files), error);
+        for (size_t index = m_max_rotated_files - 1; index >= 1; --index) {
+            std::filesystem::rename(rotated_path(index), rotated_path(index + 1), error);
+        }
+        std::filesystem::rename(m_path, rotated_path(1), error);
+    }
+
+    return map();
+}
+
+RingBufferSink::RingBufferSink(const size_t capacity) :
+    m_buffer(std::max<size_t>(capacity, 1))
+{
+}
+
+void RingBufferSink::write(std::string_view text)
+{
+    std::scoped_lock lock(m_mutex);
+    if (text.size() >= m_buffer.size()) {
+        text = text.substr(text.size() - m_buffer.size());
+    }
+
+    const size_t first_part = std::min(text.size(), m_buffer.size() - m_next);
+    std::ranges::copy(text.substr(0, first_part), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_next));
+    std::ranges::copy(text.substr(first_part), m_buffer.begin());
+
+    if (m_next + text.size() >= m_buffer.size()) {
+        m_wrapped = true;
+    }
+    m_next = (m_next + text.size()) % m_buffer.size();
+}
+
+std::string RingBufferSink::contents() const
+{
+    std::scoped_lock lock(m_mutex);
+    if (!m_wrapped) {
+        return std::string(m_buffer.data(), m_next);
+    }
+
+    std::string text(m_buffer.begin() + static_cast<std::ptrdiff_t>(m_next), m_buffer.end());
+    text.append(m_buffer.data(), m_next);
+    return text;
+}
+
+} // namespace cppline::errors
@@ -0,0 +1,124 @@
+export module ErrorHandling:LogSinks;
+
+import std;
+import :Expected;
+
+export namespace cppline::errors {
+
+// Destination of rendered log text. Logger serializes calls to write and flush.
+class LogSink
+{
+public:
+    virtual ~LogSink() = default;
+
+    virtual void write(std::string_view text) = 0;
+    virtual void flush() {}
+};
+
+// Writes to std::cout and flushes after every write, the default sink
+class ConsoleSink final : public LogSink
+{
+public:
+    void write(std::string_view text) override;
+    void flush() override;
+};
+
+// Discards everything, for measuring the logging overhead itself
+class NullSink final : public LogSink
+{
+public:
+    void write(std::string_view) override {}
+};
+
+// Collects text in memory and writes it to the file in large chunks
+class BufferedFileSink final : public LogSink
+{
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    static Expected<std::shared_ptr<BufferedFileSink>> try_open(const std::filesystem::path& path,
+                                                                size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    static std::shared_ptr<BufferedFileSink> open(const std::filesystem::path& path,
+                                                  size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    BufferedFileSink(std::ofstream file, size_t buffer_size);
+    ~BufferedFileSink() override;
+
+    void write(std::string_view text) override;
+    void flush() override;
+
+private:
+    void write_buffer();
+
+    std::ofstream m_file;
+    std::string m_buffer;
+    size_t m_buffer_size;
+};
+
+// Copies text straight into a memory mapped file, no system call per write.
+// When a write does not fit the file is closed, renamed to <path>.1 (older files shift to <path>.2 and so on,
+// at most max_rotated_files are kept) and a new file is mapped. Writes longer than file_size span several files.
+class MemoryMappedFileSink final : public LogSink
+{
+public:
+    static constexpr size_t DEFAULT_FILE_SIZE = 4 * 1024 * 1024;
+    static constexpr size_t DEFAULT_ROTATED_FILES = 4;
+
+    static Expected<std::shared_ptr<MemoryMappedFileSink>> try_open(const std::filesystem::path& path,
+                                                                    size_t file_size = DEFAULT_FILE_SIZE,
+                                                                    size_t max_rotated_files = DEFAULT_ROTATED_FILES);
+    static std::shared_ptr<MemoryMappedFileSink> open(const std::filesystem::path& path,
+                                                      size_t file_size = DEFAULT_FILE_SIZE,
+                                                      size_t max_rotated_files = DEFAULT_ROTATED_FILES);
+
+    MemoryMappedFileSink(std::filesystem::path path, size_t file_size, size_t max_rotated_files);
+    ~MemoryMappedFileSink() override; // Truncates the current file to the text written
+
+    void write(std::string_view text) override;
+    void flush() override;
+
+    // Text discarded because no file could be mapped. The next write maps the file again.
+    size_t dropped_bytes() const noexcept;
+
+    MemoryMappedFileSink(const MemoryMappedFileSink&) = delete;
+    MemoryMappedFileSink& operator=(const MemoryMappedFileSink&) = delete;
+
+private:
+    // Native handles are kept as integers so the interface stays platform independent
+    struct MappedFile {
+        std::intptr_t file = -1;
+        std::intptr_t mapping = 0;
+        char* view = nullptr;
+    };
+
+    ExpectedVoid map();
+    void unmap();
+    ExpectedVoid rotate();
+
+    std::filesystem::path m_path;
+    size_t m_file_size;
+    size_t m_max_rotated_files;
+    MappedFile m_mapped;
+    size_t m_offset = 0;
+    std::atomic<size_t> m_dropped_bytes = 0;
+};
+
+// Keeps the most recent capacity bytes in memory, e.g. to attach to a crash dump
+class RingBufferSink final : public LogSink
+{
+public:
+    explicit RingBufferSink(size_t capacity);
+
+    void write(std::string_view text) override;
+
+    // Oldest text first
+    std::string contents() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<char> m_buffer;
+    size_t m_next = 0; // Where the next byte goes
+    bool m_wrapped = false;
+};
+
+} // namespace cppline::errors
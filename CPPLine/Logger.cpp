@@ -1,56 +1,302 @@
+module;
+
+#include "Macros.hpp"
+
 module ErrorHandling;
 import :Enums;
 import :Exception;
+import :Error;
 import :Context;
+import :Stacktrace;
+import :AsyncLogger;
+import :LogSinks;
+import :BinaryLog;
 
 import std;
-import "magic_enum.hpp";
 
 namespace cppline::errors
 {
+namespace {
+std::unique_ptr<AsyncLogWriter> g_async_writer;
+std::atomic<AsyncLogWriter*> g_active_writer = nullptr;
+std::mutex g_output_mutex; // Serializes sink calls, so concurrent synchronous records do not interleave
+std::shared_ptr<LogSink> g_sink = std::make_shared<ConsoleSink>();
+std::atomic<LogEncoding> g_encoding = LogEncoding::Text;
+}
+
+std::atomic<LogLevel> Logger::s_level = LogLevel::Info;
+
+static_assert(static_cast<int>(LogLevel::Trace) == CPPLINE_LOG_LEVEL_TRACE &&
+              static_cast<int>(LogLevel::Debug) == CPPLINE_LOG_LEVEL_DEBUG &&
+              static_cast<int>(LogLevel::Info) == CPPLINE_LOG_LEVEL_INFO &&
+              static_cast<int>(LogLevel::Warn) == CPPLINE_LOG_LEVEL_WARN &&
+              static_cast<int>(LogLevel::Error) == CPPLINE_LOG_LEVEL_ERROR &&
+              static_cast<int>(LogLevel::Off) == CPPLINE_LOG_LEVEL_OFF);
 
 void Logger::log(const std::string& message)
 {
-    std::cout << message.c_str() << std::endl;
+    log(LogLevel::Info, message);
 }
 
 void Logger::log(const std::string& message, const Exception& exception)
 {
-    std::cout << message.c_str() << std::endl;
-    const std::string exception_info
-        = std::format("Exception:\n{}", format_context(exception.get_context()));
+    log(LogLevel::Error, message, exception);
+}
+
+void Logger::log(const std::string& message, Exception&& exception)
+{
+    log(LogLevel::Error, message, std::move(exception));
+}
 
-    std::cout << exception_info << std::endl;
+void Logger::log(const std::string& message, const Error& error)
+{
+    log(LogLevel::Error, message, error);
 }
 
-void Logger::log(const Context& context, const std::source_location& location)
+void Logger::log(const std::string& message, Error&& error)
 {
-    const std::string context_info
-        = std::format("Context:\n{}", format_context(location_to_context(location) << context));
+    log(LogLevel::Error, message, std::move(error));
+}
 
-    std::cout << context_info << std::endl;
+void Logger::log(const Context& context, const std::source_location& location)
+{
+    log(LogLevel::Info, context, location);
 }
 
 void Logger::log(const std::string& message, const Context& context, const std::source_location& location)
 {
-    const std::string context_info = std::format("Log Message: {}\n{}",
-                                                 message,
-                                                 format_context(location_to_context(location) << context));
+    log(LogLevel::Info, message, context, location);
+}
+
+void Logger::log(const LogLevel level, const std::string& message)
+{
+    if (is_enabled(level)) {
+        submit(LogRecord{ LogRecordKind::Message, level, message });
+    }
+}
+
+void Logger::log(const LogLevel level, const std::string& message, const Exception& exception)
+{
+    if (is_enabled(level)) {
+        submit(LogRecord{ LogRecordKind::MessageWithException, level, message, {}, {}, exception.get_stacktrace(),
+                          exception.share_context() });
+    }
+}
+
+void Logger::log(const LogLevel level, const std::string& message, Exception&& exception)
+{
+    if (is_enabled(level)) {
+        auto context = exception.share_context();
+        submit(LogRecord{ LogRecordKind::MessageWithException, level, message, {}, {}, std::move(exception).take_stacktrace(),
+                          std::move(context) });
+    }
+}
+
+void Logger::log(const LogLevel level, const std::string& message, const Error& error)
+{
+    if (!is_enabled(level)) {
+        return;
+    }
+    if (auto context = error.share_context()) {
+        submit(LogRecord{ LogRecordKind::MessageWithException, level, message, {}, {}, error.get_stacktrace(), std::move(context) });
+    }
+    else {
+        submit(LogRecord{ LogRecordKind::MessageWithException, level, message, error.get_context() }); // No stacktrace without an Exception
+    }
+}
+
+void Logger::log(const LogLevel level, const std::string& message, Error&& error)
+{
+    if (!is_enabled(level)) {
+        return;
+    }
+    if (auto context = error.share_context()) {
+        submit(LogRecord{ LogRecordKind::MessageWithException, level, message, {}, {}, std::move(error).take_stacktrace(),
+                          std::move(context) });
+    }
+    else {
+        submit(LogRecord{ LogRecordKind::MessageWithException, level, message, error.get_context() });
+    }
+}
+
+void Logger::log(const LogLevel level, const Context& context, const std::source_location& location)
+{
+    if (is_enabled(level)) {
+        submit(LogRecord{ LogRecordKind::Context, level, {}, context, location });
+    }
+}
+
+void Logger::log(const LogLevel level, const std::string& message, const Context& context, const std::source_location& location)
+{
+    if (is_enabled(level)) {
+        submit(LogRecord{ LogRecordKind::MessageWithContext, level, message, context, location });
+    }
+}
+
+void Logger::set_level(const LogLevel level)
+{
+    s_level.store(level, std::memory_order_relaxed);
+}
 
-    std::cout << context_info << std::endl;
+LogLevel Logger::get_level()
+{
+    return s_level.load(std::memory_order_relaxed);
 }
 
-std::string Logger::format_context(const Context& context)
+void Logger::start_async(const AsyncLoggerOptions& options)
+{
+    stop_async();
+    g_async_writer = std::make_unique<AsyncLogWriter>(options, &Logger::format_record, &Logger::write_output);
+    g_active_writer.store(g_async_writer.get(), std::memory_order_release);
+}
+
+void Logger::stop_async()
+{
+    g_active_writer.store(nullptr, std::memory_order_release);
+    g_async_writer.reset();
+}
+
+bool Logger::is_async()
+{
+    return g_active_writer.load(std::memory_order_acquire) != nullptr;
+}
+
+void Logger::set_sink(std::shared_ptr<LogSink> sink)
+{
+    flush();
+    std::scoped_lock lock(g_output_mutex);
+    g_sink = sink != nullptr ? std::move(sink) : std::make_shared<ConsoleSink>();
+}
+
+std::shared_ptr<LogSink> Logger::get_sink()
+{
+    std::scoped_lock lock(g_output_mutex);
+    return g_sink;
+}
+
+void Logger::set_encoding(const LogEncoding encoding)
+{
+    flush();
+    g_encoding.store(encoding, std::memory_order_relaxed);
+}
+
+LogEncoding Logger::get_encoding()
+{
+    return g_encoding.load(std::memory_order_relaxed);
+}
+
+ExpectedVoid Logger::decode_binary(std::string_view input, std::string& output)
+{
+    // A record never starts with a zero byte, so one marks the unused tail of a mapped file that was not closed
+    while (!input.empty() && input.front() != '\0') {
+        auto decoded = binary_log::decode(input);
+        return_on_error(decoded);
+
+        decoded->record.location.file_name = decoded->file_name.c_str();
+        std::string stacktrace;
+        if (decoded->frames.has_value()) {
+            stacktrace = "\n";
+            for (const std::uint64_t address : decoded->frames.value()) {
+                stacktrace += std::format("0x{:016x}\n", address);
+            }
+        }
+        format_text(decoded->record, stacktrace, output, decoded->named_enums);
+    }
+    return {};
+}
+
+void Logger::flush()
+{
+    if (AsyncLogWriter* writer = g_active_writer.load(std::memory_order_acquire)) {
+        writer->flush();
+    }
+
+    std::scoped_lock lock(g_output_mutex);
+    g_sink->flush();
+}
+
+size_t Logger::dropped_count()
+{
+    const AsyncLogWriter* writer = g_active_writer.load(std::memory_order_acquire);
+    return writer == nullptr ? 0 : writer->dropped_count();
+}
+
+void Logger::submit(LogRecord&& record)
+{
+    if (AsyncLogWriter* writer = g_active_writer.load(std::memory_order_acquire)) {
+        writer->push(std::move(record));
+        return;
+    }
+
+    std::string output;
+    format_record(record, output);
+    write_output(output);
+}
+
+void Logger::format_record(const LogRecord& record, std::string& output)
+{
+    if (g_encoding.load(std::memory_order_relaxed) == LogEncoding::Binary) {
+        binary_log::encode(record, output);
+        return;
+    }
+
+    format_text(record, record.stacktrace.has_value() ? StacktraceFormatter::format(record.stacktrace.value()) : std::string{}, output);
+}
+
+// An empty stacktrace means none was captured, a rendered one always starts with a newline
+void Logger::format_text(const LogRecord& record, const std::string_view stacktrace, std::string& output,
+                         const std::span<const NamedEnum> named_enums)
+{
+    switch (record.kind) {
+    case LogRecordKind::Message:
+        output += std::format("{}\n", record.message);
+        break;
+    case LogRecordKind::MessageWithException:
+        output += std::format("{}\nException:\n{}", record.message, format_context(record.get_context(), named_enums));
+        if (!stacktrace.empty()) {
+            output += std::format("\nStacktrace:{}", stacktrace);
+        }
+        output += '\n';
+        break;
+    case LogRecordKind::MessageWithContext:
+        output += std::format("Log Message: {}\n{}\n", record.message,
+                              format_context(location_to_context(record.location) << record.context, named_enums));
+        break;
+    case LogRecordKind::Context:
+        output += std::format("Context:\n{}\n",
+                              format_context(location_to_context(record.location) << record.context, named_enums));
+        break;
+    case LogRecordKind::MessageWithEnums:
+        output += std::format("Log message: {}\n{}", record.message, format_enums(record.context, named_enums));
+        break;
+    case LogRecordKind::Enums:
+        output += std::format("{}\n", format_enums(record.context, named_enums));
+        break;
+    }
+}
+
+void Logger::write_output(const std::string_view text)
+{
+    std::scoped_lock lock(g_output_mutex);
+    g_sink->write(text);
+}
+
+std::string Logger::format_context(const Context& context, const std::span<const NamedEnum> named_enums)
 {
     std::string context_string = "Context: {\n";
-    for (auto [key, value] : context.get_enum_params())
+    for (const auto [key, value] : context.get_enum_params())
+    {
+        context_string += std::format("\t[{} : {}]\n", enum_type_name(key), enum_to_string(key, value));
+    }
+
+    for (const auto& [type_name, value_name] : named_enums)
     {
-        context_string += std::format("\t[{} : {}]\n", magic_enum::enum_name(key), enum_to_string(key, value));
+        context_string += std::format("\t[{} : {}]\n", type_name, value_name);
     }
 
-    for (auto [key, value] : context.get_string_params())
+    for (const auto [key, value] : context.get_string_params())
     {
-        context_string += std::format("\t[{} : {}]\n", magic_enum::enum_name(key), value);
+        context_string += std::format("\t[{} : {}]\n", enum_name(key), value);
     }
 
     context_string += "}";
@@ -58,4 +304,18 @@ std::string Logger::format_context(const Context& context)
     return context_string;
 }
 
+std::string Logger::format_enums(const Context& context, const std::span<const NamedEnum> named_enums)
+{
+    std::string message;
+    for (const auto [key, value] : context.get_enum_params()) {
+        message += std::format("enum type: {}, enum value: {}\n", enum_type_name(key),
+                               enum_to_string(key, value));
+    }
+    for (const auto& [type_name, value_name] : named_enums) {
+        message += std::format("enum type: {}, enum value: {}\n", type_name, value_name);
+    }
+
+    return message;
+}
+
 }
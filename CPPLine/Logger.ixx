@@ -2,18 +2,30 @@ export module ErrorHandling:Logger;
 
 import :Enums;
 import :Exception;
+import :Error;
 import :Context;
+import :AsyncLogger;
+import :LogSinks;
+import :Expected;
 
 import std;
-import "magic_enum.hpp";
 
 namespace cppline::errors {
 
+export enum class LogEncoding {
+    Text,   // Human-readable, formatted when the record is written
+    Binary, // Raw ids, enum values and strings, see :BinaryLog. Rendered offline by decode_binary
+};
+
 export class Logger final
 {
 public:
+    // Without a level, records are logged at Info, or Error if they carry an error
     static void log(const std::string& message);
     static void log(const std::string& message, const Exception& exception);
+    static void log(const std::string& message, Exception&& exception);
+    static void log(const std::string& message, const Error& error);
+    static void log(const std::string& message, Error&& error);
     static void log(const Context& context,
                     const std::source_location& location = std::source_location::current());
 
@@ -23,31 +35,87 @@ public:
 
     template <EnumType... Enums>
     static void log(const std::string& message, Enums... enums) {
-        std::cout << std::format("Log message: {}\n{}",
-                                 message,
-                                 format_enums(std::forward<Enums>(enums)...)).c_str();
+        log(LogLevel::Info, message, enums...);
     }
 
     template <EnumType... Enums>
     static void log(Enums... enums) {
-        std::cout << format_enums(std::forward<Enums>(enums)...).c_str() << std::endl;
+        log(LogLevel::Info, enums...);
     }
 
-private:
-    static std::string format_context(const Context& context);
+    // Records below get_level() are dropped before anything is copied or formatted.
+    // Use CPPLINE_LOG to also skip evaluating the arguments.
+    // Records of an Exception or Error share its merged context. A captured stacktrace is copied,
+    // unless the error is passed as an rvalue and the stacktrace can be moved out.
+    static void log(LogLevel level, const std::string& message);
+    static void log(LogLevel level, const std::string& message, const Exception& exception);
+    static void log(LogLevel level, const std::string& message, Exception&& exception);
+    static void log(LogLevel level, const std::string& message, const Error& error);
+    static void log(LogLevel level, const std::string& message, Error&& error);
+    static void log(LogLevel level, const Context& context,
+                    const std::source_location& location = std::source_location::current());
+
+    static void log(LogLevel level,
+                    const std::string& message,
+                    const Context& context,
+                    const std::source_location& location = std::source_location::current());
 
     template <EnumType... Enums>
-    static std::string format_enums(Enums... enums) {
-        EnumsMap map = create_enum_map(std::forward<Enums>(enums)...);
-        std::string message;
-        for (auto [key, value] : map) {
-            message += std::format("enum type: {}, enum value: {}\n", magic_enum::enum_name(key),
-                                   enum_to_string(key, value));
+    static void log(const LogLevel level, const std::string& message, Enums... enums) {
+        if (is_enabled(level)) {
+            submit(LogRecord{ LogRecordKind::MessageWithEnums, level, message, Context(enums...) });
         }
+    }
 
-        return message;
+    template <EnumType... Enums>
+    static void log(const LogLevel level, Enums... enums) {
+        if (is_enabled(level)) {
+            submit(LogRecord{ LogRecordKind::Enums, level, {}, Context(enums...) });
+        }
     }
 
+    // Minimum level of logged records, Info unless set
+    static void set_level(LogLevel level);
+    static LogLevel get_level();
+    static bool is_enabled(const LogLevel level) noexcept {
+        return level >= s_level.load(std::memory_order_relaxed) && level != LogLevel::Off;
+    }
+
+    // Until stop_async, log calls only queue a record and a background thread formats and writes it.
+    // Start and stop while no other thread is logging.
+    static void start_async(const AsyncLoggerOptions& options = {});
+    static void stop_async(); // Writes the queued records first
+    static bool is_async();
+
+    // Where rendered records are written, a ConsoleSink unless set. nullptr restores the console.
+    static void set_sink(std::shared_ptr<LogSink> sink);
+    static std::shared_ptr<LogSink> get_sink();
+
+    // Set while no other thread is logging, records of both encodings in one stream cannot be decoded
+    static void set_encoding(LogEncoding encoding);
+    static LogEncoding get_encoding();
+
+    // Renders a stream of binary records in the text encoding, up to the end of input or a zero byte.
+    // Stacktrace frames are shown as addresses, they can only be symbolized by the process that logged them.
+    static ExpectedVoid decode_binary(std::string_view input, std::string& output);
+
+    // Waits until every record logged before the call is written, then flushes the sink
+    static void flush();
+    static size_t dropped_count();
+
+private:
+    static void submit(LogRecord&& record);
+    static void format_record(const LogRecord& record, std::string& output);
+    // named_enums are rendered after the enums in record.context, see binary_log::DecodedRecord
+    static void format_text(const LogRecord& record, std::string_view stacktrace, std::string& output,
+                            std::span<const NamedEnum> named_enums = {});
+    static void write_output(std::string_view text);
+
+    static std::string format_context(const Context& context, std::span<const NamedEnum> named_enums);
+    static std::string format_enums(const Context& context, std::span<const NamedEnum> named_enums);
+
+    static std::atomic<LogLevel> s_level;
+
 public:
     // Static class:
     Logger() = delete;
@@ -58,4 +126,4 @@ public:
     Logger& operator=(Logger&&) = delete;
 };
 
-} // namespace cppline::errors
\ No newline at end of file
+} // namespace cppline::errors
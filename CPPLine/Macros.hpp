@@ -1,9 +1,57 @@
 #pragma once
 
-#define return_on_error(expr)                               \
-do {                                                        \
-    auto result = expr;                                     \
-    if (!result.has_value()) {                              \
-        return make_unexpected(std::move(result.error()));  \
-    }                                                       \
-} while (false)
\ No newline at end of file
+#if defined(_MSC_VER)
+#define CPPLINE_NOINLINE __declspec(noinline)
+#else
+#define CPPLINE_NOINLINE __attribute__((noinline))
+#endif
+
+// Binds to the result instead of copying it, the error is moved into the returned unexpected
+#define return_on_error(expr)                                   \
+do {                                                            \
+    auto&& result = expr;                                       \
+    if (!result.has_value()) {                                  \
+        return make_unexpected(std::move(result).error());      \
+    }                                                           \
+} while (false)
+
+
+// Log levels for CPPLINE_LOG, in the order of cppline::errors::LogLevel
+#define CPPLINE_LOG_LEVEL_TRACE 0
+#define CPPLINE_LOG_LEVEL_DEBUG 1
+#define CPPLINE_LOG_LEVEL_INFO 2
+#define CPPLINE_LOG_LEVEL_WARN 3
+#define CPPLINE_LOG_LEVEL_ERROR 4
+#define CPPLINE_LOG_LEVEL_OFF 5
+
+// Calls below this level are compiled out, define it for the whole build to override
+#ifndef CPPLINE_LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define CPPLINE_LOG_MIN_LEVEL CPPLINE_LOG_LEVEL_TRACE
+#else
+#define CPPLINE_LOG_MIN_LEVEL CPPLINE_LOG_LEVEL_INFO
+#endif
+#endif
+
+// CPPLINE_LOG(Debug, "message", context) logs through Logger::log at LogLevel::Debug.
+// The arguments are only evaluated if the level is compiled in and enabled at runtime.
+#define CPPLINE_LOG(level, ...)                                                                        \
+do {                                                                                                   \
+    if constexpr (static_cast<int>(cppline::errors::LogLevel::level) >= CPPLINE_LOG_MIN_LEVEL) {      \
+        if (cppline::errors::Logger::is_enabled(cppline::errors::LogLevel::level)) {                  \
+            cppline::errors::Logger::log(cppline::errors::LogLevel::level, __VA_ARGS__);              \
+        }                                                                                              \
+    }                                                                                                  \
+} while (false)
+
+// Parser instrumentation (ParserStats), define CPPLINE_PARSER_STATS=1 for the whole build to enable it
+#ifndef CPPLINE_PARSER_STATS
+#define CPPLINE_PARSER_STATS 0
+#endif
+
+// CPPLINE_PARSER_STAT(++m_stats.tokens_scanned) runs the statement only in instrumented builds
+#if CPPLINE_PARSER_STATS
+#define CPPLINE_PARSER_STAT(...) __VA_ARGS__
+#else
+#define CPPLINE_PARSER_STAT(...) do {} while (false)
+#endif
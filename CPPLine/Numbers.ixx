@@ -0,0 +1,104 @@
+export module CPPLine:Numbers;
+
+import std;
+import ErrorHandling;
+
+using namespace cppline::errors;
+
+namespace cppline {
+
+export template <typename T>
+concept NumberType = (std::integral<T> && !std::same_as<T, bool>) || std::floating_point<T>;
+
+constexpr size_t MAX_NUMBER_LENGTH = 128;
+
+constexpr bool is_digit_separator(const char character)
+{
+    return character == '\'' || character == '_';
+}
+
+// Characters a number may start or end with, letters cover hex digits, exponents, inf and nan
+template <NumberType T>
+constexpr bool is_number_boundary(const char character)
+{
+    return (character >= '0' && character <= '9') || (character >= 'a' && character <= 'z') ||
+        (character >= 'A' && character <= 'Z') || (std::floating_point<T> && character == '.');
+}
+
+// Parses an integer or floating point number without allocating or throwing.
+// Accepts an optional sign, 0x / 0o / 0b prefixes for integers and ' or _ as digit separators (1'000'000, 0xFF_FF).
+export template <NumberType T>
+Expected<T> parse_number(const std::string_view text)
+{
+    auto invalid = [text](const char* reason) {
+        return make_unexpected(Status::InvalidValue,
+                               Context{ Param::ArgumentValue, text } <<
+                               Context{ Param::ErrorMessage, reason });
+    };
+
+    std::string_view digits = text;
+    bool negative = false;
+    if (!digits.empty() && (digits.front() == '+' || digits.front() == '-')) {
+        negative = digits.front() == '-';
+        digits.remove_prefix(1);
+    }
+
+    int base = 10;
+    if constexpr (std::integral<T>) {
+        if (digits.size() > 2 && digits[0] == '0') {
+            switch (digits[1]) {
+            case 'x': case 'X': base = 16; break;
+            case 'o': case 'O': base = 8; break;
+            case 'b': case 'B': base = 2; break;
+            default: break;
+            }
+            if (base != 10) {
+                digits.remove_prefix(2);
+            }
+        }
+    }
+
+    if (digits.empty() || !is_number_boundary<T>(digits.front()) || !is_number_boundary<T>(digits.back())) {
+        return invalid("expected a number");
+    }
+
+    // Copy into a local buffer without separators, from_chars does not know about them
+    std::array<char, MAX_NUMBER_LENGTH> buffer;
+    size_t length = 0;
+    if (negative) {
+        buffer[length++] = '-';
+    }
+    for (size_t index = 0; index < digits.size(); ++index) {
+        const char character = digits[index];
+        if (is_digit_separator(character)) {
+            if (is_digit_separator(digits[index - 1])) {
+                return invalid("misplaced digit separator");
+            }
+            continue;
+        }
+        if (length == buffer.size()) {
+            return invalid("number is too long");
+        }
+        buffer[length++] = character;
+    }
+
+    T value{};
+    const char* const end = buffer.data() + length;
+    std::from_chars_result result;
+    if constexpr (std::integral<T>) {
+        result = std::from_chars(buffer.data(), end, value, base);
+    }
+    else {
+        result = std::from_chars(buffer.data(), end, value, std::chars_format::general);
+    }
+
+    if (result.ec == std::errc::result_out_of_range) {
+        return invalid("number is out of range");
+    }
+    if (result.ec != std::errc{} || result.ptr != end) {
+        return invalid("expected a number");
+    }
+    return value;
+}
+
+} // namespace cppline
@@ -0,0 +1,153 @@
+module CPPLine;
+
+import std;
+
+namespace cppline {
+
+namespace {
+constexpr std::uint32_t MAX_SEED = 1u << 16;
+constexpr int MAX_BUILD_ATTEMPTS = 4; // Each failed attempt doubles the slot count
+}
+
+OptionTable::OptionTable(std::pmr::memory_resource* resource) :
+    m_resource(resource),
+    m_seeds(resource),
+    m_slots(resource),
+    m_names(resource)
+{
+}
+
+bool OptionTable::build(const std::span<const Entry> entries)
+{
+    clear();
+    if (entries.empty()) {
+        return true;
+    }
+
+    const size_t bucket_count = std::bit_ceil(std::max<size_t>(entries.size() / 2, 1));
+    size_t slot_count = std::bit_ceil(entries.size() * 2);
+
+    for (int attempt = 0; attempt < MAX_BUILD_ATTEMPTS; ++attempt) {
+        if (try_build(entries, bucket_count, slot_count)) {
+            return true;
+        }
+        slot_count *= 2;
+    }
+
+    clear();
+    return false;
+}
+
+void OptionTable::clear()
+{
+    m_seeds.clear();
+    m_slots.clear();
+    m_names.clear();
+}
+
+std::optional<size_t> OptionTable::find(const std::string_view name) const noexcept
+{
+    if (m_seeds.empty()) {
+        return std::nullopt;
+    }
+
+    const std::uint64_t hash = hash_name(name);
+    const std::uint32_t seed = m_seeds[hash & (m_seeds.size() - 1)];
+    if (seed == 0) {
+        return std::nullopt;
+    }
+
+    const Slot& slot = m_slots[displace(hash, seed) & (m_slots.size() - 1)];
+    if (!slot.used || slot.hash != hash ||
+        std::string_view(m_names).substr(slot.name_offset, slot.name_length) != name) {
+        return std::nullopt;
+    }
+
+    return slot.index;
+}
+
+bool OptionTable::try_build(const std::span<const Entry> entries, const size_t bucket_count, const size_t slot_count)
+{
+    std::pmr::vector<std::uint64_t> hashes(entries.size(), m_resource);
+    std::pmr::vector<std::pmr::vector<size_t>> buckets(bucket_count, m_resource);
+    for (size_t entry = 0; entry < entries.size(); ++entry) {
+        hashes[entry] = hash_name(entries[entry].first);
+        buckets[hashes[entry] & (bucket_count - 1)].push_back(entry);
+    }
+
+    // Place the largest buckets first, while most slots are still free
+    std::pmr::vector<size_t> order(bucket_count, m_resource);
+    std::iota(order.begin(), order.end(), size_t{ 0 });
+    std::ranges::stable_sort(order, std::greater{}, [&buckets](const size_t bucket) { return buckets[bucket].size(); });
+
+    m_seeds.assign(bucket_count, 0);
+    m_slots.assign(slot_count, Slot{});
+    m_names.clear();
+
+    std::pmr::vector<size_t> candidate_slots(m_resource);
+    for (const size_t bucket : order) {
+        const auto& members = buckets[bucket];
+        if (members.empty()) {
+            break; // Buckets are sorted by size, the rest are empty too
+        }
+
+        bool placed = false;
+        for (std::uint32_t seed = 1; seed < MAX_SEED && !placed; ++seed) {
+            candidate_slots.clear();
+            placed = true;
+            for (const size_t member : members) {
+                const size_t slot = displace(hashes[member], seed) & (slot_count - 1);
+                if (m_slots[slot].used || std::ranges::contains(candidate_slots, slot)) {
+                    placed = false;
+                    break;
+                }
+                candidate_slots.push_back(slot);
+            }
+
+            if (placed) {
+                m_seeds[bucket] = seed;
+            }
+        }
+
+        if (!placed) {
+            return false;
+        }
+
+        for (const auto [member, slot] : std::views::zip(members, candidate_slots)) {
+            const auto& [name, index] = entries[member];
+            m_slots[slot] = Slot{ hashes[member],
+                                  static_cast<std::uint32_t>(m_names.size()),
+                                  static_cast<std::uint32_t>(name.size()),
+                                  index,
+                                  true };
+            m_names.append(name);
+        }
+    }
+
+    return true;
+}
+
+std::uint64_t OptionTable::hash_name(const std::string_view name) noexcept
+{
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char character : name) {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::uint64_t OptionTable::displace(const std::uint64_t hash, const std::uint32_t seed) noexcept
+{
+    // Seeded 64 bit finalizer, spreads the FNV bits over the whole slot index
+    std::uint64_t value = hash ^ (static_cast<std::uint64_t>(seed) * 0x9E3779B97F4A7C15ull);
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+} // namespace cppline
@@ -0,0 +1,43 @@
+export module CPPLine:OptionTable;
+
+import std;
+
+namespace cppline {
+
+// Read-only, collision-free hash table from option names to option indices.
+// Built once after registration (hash and displace): every bucket stores a seed that
+// places all of its names into distinct slots, so a lookup is one hash and one compare.
+class OptionTable final
+{
+public:
+    using Entry = std::pair<std::string_view, size_t>;
+
+    explicit OptionTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Returns false if no collision-free layout was found, the table is left empty in that case.
+    bool build(std::span<const Entry> entries);
+    void clear();
+
+    std::optional<size_t> find(std::string_view name) const noexcept;
+
+private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::uint32_t name_offset = 0;
+        std::uint32_t name_length = 0;
+        size_t index = 0;
+        bool used = false;
+    };
+
+    bool try_build(std::span<const Entry> entries, size_t bucket_count, size_t slot_count);
+
+    static std::uint64_t hash_name(std::string_view name) noexcept;
+    static std::uint64_t displace(std::uint64_t hash, std::uint32_t seed) noexcept;
+
+    std::pmr::memory_resource* m_resource; // Used for the table and for the scratch space of build
+    std::pmr::vector<std::uint32_t> m_seeds; // Per bucket displacement seed, 0 marks an empty bucket
+    std::pmr::vector<Slot> m_slots;
+    std::pmr::string m_names; // All names back to back, slots refer into it by offset
+};
+
+} // namespace cppline
@@ -10,110 +10,263 @@ using namespace cppline::errors;
 
 namespace cppline {
 
-Parser::Parser(const std::string& description)
-    : m_description(description) {}
-
-ExpectedVoid Parser::try_add_option(const Aliases& names, const std::string& help,
+Parser::Parser(const std::string& description, std::pmr::memory_resource* resource)
+    :
+#if CPPLINE_PARSER_STATS
+      m_counting_resource(std::make_unique<CountingResource>(resource)),
+      m_resource(m_counting_resource.get()),
+#else
+      m_resource(resource),
+#endif
+      m_description(description, m_resource),
+      m_options(m_resource),
+      m_option_map(m_resource),
+      m_option_table(m_resource),
+      m_positional_options(m_resource) {}
+
+ExpectedVoid Parser::try_add_option(const Aliases& names, const std::string_view help,
                                     ParseFunctionType parse_function, const size_t argument_count, std::any default_value)
 {
-    if (std::ranges::any_of(names, [this](const std::string& name) { return m_option_map.contains(name); })) {
-        return make_unexpected(Status::OptionAlreadyDefined, Context{ Param::OptionName, join_names(names) });
-    }
-
-    Option option{ names, help, argument_count, parse_function, default_value, false };
-    m_options.push_back(option);
-
-    size_t index = m_options.size() - 1;
-    for (const auto& name : names) {
-        m_option_map[name] = index;
-    }
-
-    return success();
+    return try_add_value_option(names, help, nullptr, std::move(parse_function), argument_count,
+                                Value(std::move(default_value)));
 }
 
-ExpectedVoid Parser::try_add_option(const std::string& name, const std::string& help, ParseFunctionType parse_function,
-                                    size_t argument_count, std::any default_value)
+ExpectedVoid Parser::try_add_option(const std::string& name, const std::string_view help, ParseFunctionType parse_function,
+                                    const size_t argument_count, std::any default_value)
 {
-    return try_add_option(std::vector{ name }, help, parse_function, argument_count, default_value);
+    return try_add_value_option(std::span(&name, 1), help, nullptr, std::move(parse_function), argument_count,
+                                Value(std::move(default_value)));
 }
 
-ExpectedVoid Parser::try_add_option(const std::string& help, ParseFunctionType parse_function, size_t argument_count,
+ExpectedVoid Parser::try_add_option(const std::string_view help, ParseFunctionType parse_function, const size_t argument_count,
                                     std::any default_value)
 {
-    Option option{ {}, help, argument_count, parse_function, default_value, false };
+    return try_add_positional_value_option(help, nullptr, std::move(parse_function), argument_count,
+                                           Value(std::move(default_value)));
+}
 
-    m_positional_options.push_back(option);
+ExpectedVoid Parser::try_add_bool(const Aliases& names, const std::string_view help) {
+    return try_add_value_option(names, help,
+                                parse_bool, {},
+                                0,
+                                false); // No arguments after the option name
+}
 
-    return success();
+ExpectedVoid Parser::try_add_bool(const std::string& name, const std::string_view help) {
+    return try_add_value_option(std::span(&name, 1), help,
+                                parse_bool, {},
+                                0,
+                                false); // No arguments after the option name
+}
+
+ExpectedVoid Parser::try_add_bool(const std::string_view help) {
+    return try_add_positional_value_option(help,
+                                           parse_bool, {},
+                                           0,
+                                           false); // No arguments after the positional argument
+}
+
+ExpectedVoid Parser::try_add_int(const Aliases& names, const std::string_view help, int default_value) {
+    return try_add_value_option(names, help,
+                                parse_numeric<int>, {},
+                                1,
+                                default_value); // One argument after the name
+}
+
+ExpectedVoid Parser::try_add_int(const std::string& name, const std::string_view help, int default_value) {
+    return try_add_value_option(std::span(&name, 1), help,
+                                parse_numeric<int>, {},
+                                1,
+                                default_value); // One argument after the name
+}
+
+ExpectedVoid Parser::try_add_int(const std::string_view help) {
+    return try_add_positional_value_option(help,
+                                           parse_numeric<int>, {},
+                                           1,
+                                           {}); // One argument after the positional argument
+}
+
+ExpectedVoid Parser::try_add_int64(const Aliases& names, const std::string_view help, std::int64_t default_value) {
+    return try_add_value_option(names, help,
+                                parse_numeric<std::int64_t>, {},
+                                1,
+                                default_value); // One argument after the name
 }
 
-ExpectedVoid Parser::try_add_bool(const Aliases& names, const std::string& help) {
-    return try_add_option(names, help,
-                          parse_bool,
-                          0,
-                          false); // No arguments after the option name
+ExpectedVoid Parser::try_add_int64(const std::string& name, const std::string_view help, std::int64_t default_value) {
+    return try_add_value_option(std::span(&name, 1), help,
+                                parse_numeric<std::int64_t>, {},
+                                1,
+                                default_value); // One argument after the name
 }
 
-ExpectedVoid Parser::try_add_bool(const std::string& name, const std::string& help) {
-    return try_add_bool(std::vector{ name }, help);
+ExpectedVoid Parser::try_add_int64(const std::string_view help) {
+    return try_add_positional_value_option(help,
+                                           parse_numeric<std::int64_t>, {},
+                                           1,
+                                           {}); // One argument after the positional argument
 }
 
-ExpectedVoid Parser::try_add_bool(const std::string& help) {
-    return try_add_option(help,
-                          parse_bool,
-                          0,
-                          false); // No arguments after the positional argument
+ExpectedVoid Parser::try_add_uint64(const Aliases& names, const std::string_view help, std::uint64_t default_value) {
+    return try_add_value_option(names, help,
+                                parse_numeric<std::uint64_t>, {},
+                                1,
+                                default_value); // One argument after the name
 }
 
-ExpectedVoid Parser::try_add_int(const Aliases& names, const std::string& help, int default_value) {
-    return try_add_option(names, help,
-                          parse_int_factory(names),
-                          1,
-                          default_value); // One argument after the name
+ExpectedVoid Parser::try_add_uint64(const std::string& name, const std::string_view help, std::uint64_t default_value) {
+    return try_add_value_option(std::span(&name, 1), help,
+                                parse_numeric<std::uint64_t>, {},
+                                1,
+                                default_value); // One argument after the name
 }
 
-ExpectedVoid Parser::try_add_int(const std::string& name, const std::string& help, int default_value) {
-    return try_add_int(std::vector{ name }, help, default_value);
+ExpectedVoid Parser::try_add_uint64(const std::string_view help) {
+    return try_add_positional_value_option(help,
+                                           parse_numeric<std::uint64_t>, {},
+                                           1,
+                                           {}); // One argument after the positional argument
+}
+
+ExpectedVoid Parser::try_add_double(const Aliases& names, const std::string_view help, double default_value) {
+    return try_add_value_option(names, help,
+                                parse_numeric<double>, {},
+                                1,
+                                default_value); // One argument after the name
+}
+
+ExpectedVoid Parser::try_add_double(const std::string& name, const std::string_view help, double default_value) {
+    return try_add_value_option(std::span(&name, 1), help,
+                                parse_numeric<double>, {},
+                                1,
+                                default_value); // One argument after the name
+}
+
+ExpectedVoid Parser::try_add_double(const std::string_view help) {
+    return try_add_positional_value_option(help,
+                                           parse_numeric<double>, {},
+                                           1,
+                                           {}); // One argument after the positional argument
+}
+
+ExpectedVoid Parser::try_add_string(const Aliases& names, const std::string_view help, std::string default_value) {
+    return try_add_value_option(names, help,
+                                parse_string, {},
+                                1,
+                                std::move(default_value)); // One argument after the name
+}
+
+ExpectedVoid Parser::try_add_string(const std::string& name, const std::string_view help, std::string default_value) {
+    return try_add_value_option(std::span(&name, 1), help,
+                                parse_string, {},
+                                1,
+                                std::move(default_value)); // One argument after the name
+}
+
+ExpectedVoid Parser::try_add_string(const std::string_view help) {
+    return try_add_positional_value_option(help,
+                                           parse_string, {},
+                                           1,
+                                           {}); // One argument after the positional argument
+}
+
+ExpectedVoid Parser::try_add_value_option(const std::span<const std::string> names, const std::string_view help,
+                                          const BuiltinParseFunction builtin_parse_function, ParseFunctionType&& parse_function,
+                                          const size_t argument_count, Value&& default_value)
+{
+    if (std::ranges::any_of(names, [this](const std::string_view name) { return m_option_map.contains(name); })) {
+        return make_unexpected(Status::OptionAlreadyDefined, Context{ Param::OptionName, join_names(names) });
+    }
+
+    // Constructed in place, a copy of a pmr container would fall back to the default resource
+    auto& option = m_options.emplace_back(std::pmr::vector<std::pmr::string>(m_resource),
+                                          std::pmr::string(help, m_resource),
+                                          argument_count,
+                                          builtin_parse_function,
+                                          std::move(parse_function),
+                                          std::move(default_value),
+                                          false);
+    option.names.reserve(names.size());
+    for (const auto& name : names) {
+        option.names.emplace_back(name);
+    }
+
+    size_t index = m_options.size() - 1;
+    for (const auto& name : names) {
+        m_option_map.emplace(std::string_view(name), index);
+    }
+
+    m_option_table.clear();
+    m_frozen = false;
+    m_freeze_attempted = false;
+
+    return success();
 }
 
-ExpectedVoid Parser::try_add_int(const std::string& help) {
-    return try_add_option(help,
-                          parse_int_factory({}),
-                          1); // One argument after the positional argument
+ExpectedVoid Parser::try_add_positional_value_option(const std::string_view help, const BuiltinParseFunction builtin_parse_function,
+                                                     ParseFunctionType&& parse_function, const size_t argument_count,
+                                                     Value&& default_value)
+{
+    m_positional_options.emplace_back(std::pmr::vector<std::pmr::string>(m_resource),
+                                      std::pmr::string(help, m_resource),
+                                      argument_count,
+                                      builtin_parse_function,
+                                      std::move(parse_function),
+                                      std::move(default_value),
+                                      false);
+
+    return success();
 }
 
-ExpectedVoid Parser::try_add_string(const Aliases& names, const std::string& help, const std::string& default_value) {
-    return try_add_option(names, help,
-                          parse_string_factory(names),
-                          1,
-                          default_value); // One argument after the name
+void Parser::freeze() {
+    std::pmr::vector<OptionTable::Entry> entries(m_resource);
+    entries.reserve(m_option_map.size());
+    for (const auto& [name, index] : m_option_map) {
+        entries.emplace_back(name, index);
+    }
+
+    // Lookups fall back to m_option_map if no collision-free layout could be found
+    m_frozen = m_option_table.build(entries);
+    m_freeze_attempted = true;
+    if (!m_frozen) {
+        CPPLINE_LOG(Debug, std::format("No collision-free table for {} option names, using the option map", entries.size()));
+    }
 }
 
-ExpectedVoid Parser::try_add_string(const std::string& name, const std::string& help, const std::string& default_value) {
-    return try_add_string(std::vector{ name }, help, default_value);
+bool Parser::is_frozen() const {
+    return m_frozen;
 }
 
-ExpectedVoid Parser::try_add_string(const std::string& help) {
-    return try_add_option(help,
-                          parse_string_factory({}),
-                          1); // One argument after the positional argument
+ExpectedVoid Parser::try_parse(const std::span<const std::string_view> arguments) {
+    CPPLINE_PARSER_STAT(++m_stats.parse_calls);
+
+    auto result = parse_arguments(arguments);
+    CPPLINE_PARSER_STAT(
+        if (!result.has_value()) {
+            const Status status = result.error().get_error();
+            m_stats.errors.insert_or_assign(status, m_stats.error_count(status) + 1);
+        });
+    return result;
 }
 
+ExpectedVoid Parser::parse_arguments(const std::span<const std::string_view> arguments) {
+    if (!m_freeze_attempted) {
+        freeze();
+    }
 
-ExpectedVoid Parser::try_parse(const std::vector<std::string_view>& arguments) {
     auto pos_result = parse_positional(arguments);
     return_on_error(pos_result);
 
-    auto non_positional_arguments = pos_result.value();
-    auto np_result = parse_non_positional(non_positional_arguments);
+    // Positional arguments come first, everything after the split point is non-positional
+    auto np_result = parse_non_positional(arguments.subspan(pos_result.value()));
     return_on_error(np_result);
 
     return success();
 }
 
-void Parser::parse(const std::vector<std::string_view>& arguments) {
-    auto result = try_parse(arguments);
-    throw_on_error(result);
+void Parser::parse(const std::span<const std::string_view> arguments) {
+    throw_on_error(try_parse(arguments));
 }
 
 void Parser::print_help() const {
@@ -130,13 +283,9 @@ void Parser::print_help() const {
 
     for (const auto& option : m_options) {
         std::string names_str;
-        if (!option.names.empty()) {
-            names_str = std::accumulate(
-                option.names.begin(), option.names.end(), std::string{},
-                [](const std::string& a, const std::string& b) {
-                    return a.empty() ? b : a + ", " + b;
-                }
-            );
+        for (const auto& name : option.names) {
+            names_str += names_str.empty() ? "" : ", ";
+            names_str += std::string_view(name);
         }
         usage += std::format("[{}] ", names_str);
         help += std::format("  {} \t{}\n", names_str, option.help);
@@ -147,26 +296,52 @@ void Parser::print_help() const {
     std::cout << help << std::endl;
 }
 
-Expected<std::vector<std::string_view>> Parser::parse_positional(const std::vector<std::string_view>& arguments)
+ParserStats Parser::get_stats() const {
+#if CPPLINE_PARSER_STATS
+    ParserStats stats = m_stats;
+    stats.allocations = m_counting_resource->allocations();
+    stats.allocated_bytes = m_counting_resource->allocated_bytes();
+    return stats;
+#else
+    return {};
+#endif
+}
+
+void Parser::reset_stats() {
+    CPPLINE_PARSER_STAT(m_stats = ParserStats{});
+    CPPLINE_PARSER_STAT(m_counting_resource->reset());
+}
+
+void Parser::log_stats([[maybe_unused]] const LogLevel level) const {
+    CPPLINE_PARSER_STAT(
+        if (Logger::is_enabled(level)) {
+            Logger::log(level, get_stats().to_string());
+        });
+}
+
+Expected<size_t> Parser::parse_positional(const std::span<const std::string_view> arguments)
 {
-    std::vector<std::string_view> remaining_args = arguments;
+    CPPLINE_PARSER_STAT(const PhaseTimer timer(m_stats.positional_time));
+    size_t cursor = 0; // Number of arguments consumed by positional options
 
     for (const auto& [positional_index, option] : std::views::enumerate(m_positional_options))
     {
         const size_t args_to_consume = option.argument_count;
+        const size_t args_available = arguments.size() - cursor;
 
-        if (remaining_args.size() < args_to_consume) {
+        if (args_available < args_to_consume) {
             const auto context = Context{ Param::ExpectedArgumentCount, std::to_string(args_to_consume) } <<
-                Context{ Param::ReceivedArgumentCount, std::to_string(remaining_args.size()) };
+                Context{ Param::ReceivedArgumentCount, std::to_string(args_available) };
             return make_unexpected(Status::NotEnoughArguments, context);
         }
 
-        // Collect arguments for the parse function
-        auto args_view = remaining_args | std::views::take(args_to_consume) | std::ranges::to<std::vector<std::string_view>>();
-        remaining_args = remaining_args | std::views::drop(args_to_consume) | std::ranges::to<std::vector<std::string_view>>();
-        auto parse_result = option.parse_function(args_view);
+        const auto option_args = arguments.subspan(cursor, args_to_consume);
+        cursor += args_to_consume;
+        CPPLINE_PARSER_STAT(m_stats.tokens_scanned += args_to_consume);
+
+        auto parse_result = parse_value(option, option_args);
         if (parse_result.has_value()) {
-            option.value = parse_result.value();
+            option.value = std::move(parse_result.value());
             option.is_set = true;
         }
         else {
@@ -174,43 +349,51 @@ Expected<std::vector<std::string_view>> Parser::parse_positional(const std::vect
         }
     }
 
-    return remaining_args;
+    return cursor;
 }
 
-ExpectedVoid Parser::parse_non_positional(const std::vector<std::string_view>& arguments)
+ExpectedVoid Parser::parse_non_positional(const std::span<const std::string_view> arguments)
 {
-    std::vector<std::string_view> remaining_args = arguments;
+    CPPLINE_PARSER_STAT(const PhaseTimer timer(m_stats.non_positional_time));
+    size_t cursor = 0; // Index of the next option name in arguments
 
-    while (!remaining_args.empty())
+    while (cursor < arguments.size())
     {
-        const std::string argument_name = std::string(remaining_args.front());
+        const std::string_view argument_name = arguments[cursor];
+        CPPLINE_PARSER_STAT(++m_stats.tokens_scanned);
+        CPPLINE_PARSER_STAT(++m_stats.option_lookups);
+        CPPLINE_PARSER_STAT(m_stats.map_lookups += m_frozen ? 0 : 1);
 
-        if (!m_option_map.contains(argument_name)) {
+        const auto option_index = find_option(argument_name);
+        if (!option_index.has_value()) {
             return make_unexpected(Status::OptionNotFound, Context{ Param::OptionName, argument_name });
         }
 
-        auto& option = m_options[m_option_map[argument_name]];
+        auto& option = m_options[option_index.value()];
         if (option.is_set) {
             return make_unexpected(Status::OptionAlreadySet, Context{ Param::OptionName, argument_name });
         }
 
         const size_t args_to_consume = option.argument_count;
+        const size_t args_available = arguments.size() - cursor - 1;
 
-        if (remaining_args.size() - 1 < args_to_consume) {
+        if (args_available < args_to_consume) {
             const auto context = Context{ Param::OptionName, argument_name } <<
                 Context{ Param::ExpectedArgumentCount, std::to_string(args_to_consume) } <<
-                Context{ Param::ReceivedArgumentCount, std::to_string(remaining_args.size() - 1) };
+                Context{ Param::ReceivedArgumentCount, std::to_string(args_available) };
             return make_unexpected(Status::NotEnoughArguments, context);
         }
 
-        // Collect arguments for the parse function
-        auto args_view = remaining_args | std::views::drop(1) | std::views::take(args_to_consume) | std::ranges::to<std::vector<std::string_view>>();
-        remaining_args = remaining_args | std::views::drop(args_to_consume + 1) | std::ranges::to<std::vector<std::string_view>>();
+        // The parse function sees its arguments in place, no copy of the remaining input is made
+        const auto option_args = arguments.subspan(cursor + 1, args_to_consume);
+        cursor += args_to_consume + 1;
+        CPPLINE_PARSER_STAT(m_stats.tokens_scanned += args_to_consume);
 
-        auto parse_result = option.parse_function(args_view);
+        auto parse_result = parse_value(option, option_args);
         if (parse_result.has_value()) {
             option.value = std::move(parse_result.value());
             option.is_set = true;
+            CPPLINE_LOG(Trace, "Parsed option", Context{ Param::OptionName, argument_name });
         }
         else {
             return make_unexpected(Status::ParsingError, Context{ Param::OptionName, argument_name });
@@ -220,7 +403,29 @@ ExpectedVoid Parser::parse_non_positional(const std::vector<std::string_view>& a
     return success();
 }
 
-std::string Parser::join_names(const Aliases& names) {
+std::optional<size_t> Parser::find_option(const std::string_view name) const
+{
+    if (m_frozen) {
+        return m_option_table.find(name);
+    }
+
+    const auto option_it = m_option_map.find(name);
+    if (option_it == m_option_map.end()) {
+        return std::nullopt;
+    }
+    return option_it->second;
+}
+
+Expected<Value> Parser::parse_value(const Option& option, const std::span<const std::string_view> args)
+{
+    CPPLINE_PARSER_STAT(++m_stats.parse_function_calls);
+    CPPLINE_PARSER_STAT(m_stats.custom_parse_function_calls += option.builtin_parse_function == nullptr ? 1 : 0);
+    CPPLINE_PARSER_STAT(const PhaseTimer timer(m_stats.conversion_time));
+
+    return option.parse(args);
+}
+
+std::string Parser::join_names(const std::span<const std::string> names) {
     if (names.size() == 1) {
         return names[0];
     }
@@ -233,36 +438,45 @@ std::string Parser::join_names(const Aliases& names) {
     );
 }
 
-Expected<std::any> Parser::parse_bool(const std::vector<std::string_view>&)
+Expected<Value> Option::parse(const std::span<const std::string_view> args) const
+{
+    if (builtin_parse_function != nullptr) {
+        return builtin_parse_function(args);
+    }
+
+    auto result = parse_function(args);
+    if (!result.has_value()) {
+        return make_unexpected(std::move(result).error());
+    }
+    return Value(std::move(result.value()));
+}
+
+Expected<Value> Parser::parse_bool(std::span<const std::string_view>)
 {
     return true; // Presence implies true
 }
 
-ParseFunctionType Parser::parse_int_factory(const Aliases& names)
+// The option name is added to the error context by the caller
+template <NumberType T>
+Expected<Value> Parser::parse_numeric(const std::span<const std::string_view> args)
 {
-    return [names](const std::vector<std::string_view>& args) -> Expected<std::any> {
-        if (args.empty()) {
-            return make_unexpected(Status::MissingArgument, Context{ Param::OptionName, join_names(names) });
-        }
-        try {
-            return std::stoi(std::string(args[0]));
-        }
-        catch (const std::exception& ex) {
-            return make_unexpected(Status::InvalidValue,
-                                   Context{ Param::OptionName, join_names(names) } <<
-                                   Context{ Param::ErrorMessage, ex.what() });
-        }
-        };
+    if (args.empty()) {
+        return make_unexpected(Status::MissingArgument);
+    }
+
+    auto result = parse_number<T>(args[0]);
+    if (!result.has_value()) {
+        return make_unexpected(std::move(result).error());
+    }
+    return Value(result.value());
 }
 
-ParseFunctionType Parser::parse_string_factory(const Aliases& names)
+Expected<Value> Parser::parse_string(const std::span<const std::string_view> args)
 {
-    return [names](const std::vector<std::string_view>& args) -> Expected<std::any> {
-        if (args.empty()) {
-            return make_unexpected(Status::MissingArgument, Context{ Param::OptionName, join_names(names) });
-        }
-        return std::string(args[0]);
-        };
+    if (args.empty()) {
+        return make_unexpected(Status::MissingArgument);
+    }
+    return std::string(args[0]);
 }
 
 } // namespace cppline
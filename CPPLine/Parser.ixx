@@ -1,64 +1,116 @@
+module;
+
+#include "Macros.hpp"
+
 export module CPPLine;
 
 import std;
 export import ErrorHandling;
+export import :OptionTable;
+export import :Value;
+export import :Numbers;
+export import :ParserStats;
 
 using namespace cppline::errors;
 
 namespace cppline {
 
-export using ParseFunctionType = std::function<Expected<std::any>(const std::vector<std::string_view>&)>;
+export using ParseFunctionType = std::function<Expected<std::any>(std::span<const std::string_view>)>;
 
+// Parse function of the built-in option kinds, a plain function pointer needs no std::function
+using BuiltinParseFunction = Expected<Value> (*)(std::span<const std::string_view>);
+
+// Option metadata is allocated from the Parser's memory resource
 struct Option {
-    std::vector<std::string> names; // Empty names indicate a positional argument
-    std::string help;
+    std::pmr::vector<std::pmr::string> names; // Empty names indicate a positional argument
+    std::pmr::string help;
     size_t argument_count; // Number of arguments after the option name
+    BuiltinParseFunction builtin_parse_function; // Null for options registered with a custom parse function
     ParseFunctionType parse_function;
-    std::any value;
+    Value value;
     bool is_set = false; // Indicates if the option was set
+
+    Expected<Value> parse(std::span<const std::string_view> args) const;
 };
 
 export using Aliases = std::vector<std::string>;
 
+// True if Parser collects ParserStats, set by building with CPPLINE_PARSER_STATS=1
+export inline constexpr bool PARSER_STATS_ENABLED = CPPLINE_PARSER_STATS != 0;
+
+// Transparent hash so option names can be looked up by std::string_view without building a std::string
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(const std::string_view value) const noexcept
+    {
+        return std::hash<std::string_view>{}(value);
+    }
+};
+
+using OptionMap = std::pmr::unordered_map<std::pmr::string, size_t, StringHash, std::equal_to<>>;
+
 export class Parser {
 public:
-    explicit Parser(const std::string& description);
+    // All option metadata, alias strings, lookup tables and parse state are allocated from resource.
+    // Passing a monotonic arena lets a short-lived tool register and parse with a single upstream allocation.
+    explicit Parser(const std::string& description,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-    // General method to add an option
+    // General method to add an option.
+    // The parse function and default value are moved all the way into the stored option, pass rvalues to avoid copies.
     ExpectedVoid try_add_option(const Aliases& names,
-                                const std::string& help,
+                                std::string_view help,
                                 ParseFunctionType parse_function,
                                 size_t argument_count,
                                 std::any default_value = {});
 
     ExpectedVoid try_add_option(const std::string& name,
-                                const std::string& help,
+                                std::string_view help,
                                 ParseFunctionType parse_function,
                                 size_t argument_count,
                                 std::any default_value = {});
 
-    ExpectedVoid try_add_option(const std::string& help,
+    ExpectedVoid try_add_option(std::string_view help,
                                 ParseFunctionType parse_function,
                                 size_t argument_count,
                                 std::any default_value = {});
 
     // Specific methods for common types
-    ExpectedVoid try_add_bool(const Aliases& names, const std::string& help);
-    ExpectedVoid try_add_bool(const std::string& name, const std::string& help);
-    ExpectedVoid try_add_bool(const std::string& help);
+    ExpectedVoid try_add_bool(const Aliases& names, std::string_view help);
+    ExpectedVoid try_add_bool(const std::string& name, std::string_view help);
+    ExpectedVoid try_add_bool(std::string_view help);
+
+    ExpectedVoid try_add_int(const Aliases& names, std::string_view help, int default_value = 0);
+    ExpectedVoid try_add_int(const std::string& name, std::string_view help, int default_value = 0);
+    ExpectedVoid try_add_int(std::string_view help);
+
+    ExpectedVoid try_add_int64(const Aliases& names, std::string_view help, std::int64_t default_value = 0);
+    ExpectedVoid try_add_int64(const std::string& name, std::string_view help, std::int64_t default_value = 0);
+    ExpectedVoid try_add_int64(std::string_view help);
+
+    ExpectedVoid try_add_uint64(const Aliases& names, std::string_view help, std::uint64_t default_value = 0);
+    ExpectedVoid try_add_uint64(const std::string& name, std::string_view help, std::uint64_t default_value = 0);
+    ExpectedVoid try_add_uint64(std::string_view help);
+
+    ExpectedVoid try_add_double(const Aliases& names, std::string_view help, double default_value = 0.0);
+    ExpectedVoid try_add_double(const std::string& name, std::string_view help, double default_value = 0.0);
+    ExpectedVoid try_add_double(std::string_view help);
 
-    ExpectedVoid try_add_int(const Aliases& names, const std::string& help, int default_value = 0);
-    ExpectedVoid try_add_int(const std::string& name, const std::string& help, int default_value = 0);
-    ExpectedVoid try_add_int(const std::string& help);
+    ExpectedVoid try_add_string(const Aliases& names, std::string_view help, std::string default_value = "");
+    ExpectedVoid try_add_string(const std::string& name, std::string_view help, std::string default_value = "");
+    ExpectedVoid try_add_string(std::string_view help);
 
-    ExpectedVoid try_add_string(const Aliases& names, const std::string& help, const std::string& default_value = "");
-    ExpectedVoid try_add_string(const std::string& name, const std::string& help, const std::string& default_value = "");
-    ExpectedVoid try_add_string(const std::string& help);
+    // Build the perfect-hash lookup table over all option names. Called by the first parse after registration,
+    // if it fails lookups stay on the registration map. Registering another option drops back to the map
+    // until the next freeze.
+    void freeze();
+    bool is_frozen() const;
 
-    ExpectedVoid try_parse(const std::vector<std::string_view>& arguments);
+    ExpectedVoid try_parse(std::span<const std::string_view> arguments);
 
     template <typename T>
-    Expected<T> try_get(const std::string& name) const;
+    Expected<T> try_get(std::string_view name) const;
 
     template <typename T>
     Expected<T> try_get_positional(size_t index) const;
@@ -72,15 +124,24 @@ public:
     template <typename... Args>
     void add_int(Args&&... args);
 
+    template <typename... Args>
+    void add_int64(Args&&... args);
+
+    template <typename... Args>
+    void add_uint64(Args&&... args);
+
+    template <typename... Args>
+    void add_double(Args&&... args);
+
     template <typename... Args>
     void add_string(Args&&... args);
 
     // Parse the command-line arguments
-    void parse(const std::vector<std::string_view>& arguments);
+    void parse(std::span<const std::string_view> arguments);
 
     // Retrieve the parsed value
     template <typename T>
-    T get(const std::string& name) const;
+    T get(std::string_view name) const;
 
     // Retrieve positional argument by index
     template <typename T>
@@ -89,100 +150,335 @@ public:
     // Print help message
     void print_help() const;
 
-private:
-    Expected<std::vector<std::string_view>> parse_positional(const std::vector<std::string_view>& arguments);
-    ExpectedVoid parse_non_positional(const std::vector<std::string_view>& arguments);
-
-    static std::string join_names(const Aliases& names);
-
-    static Expected<std::any> parse_bool(const std::vector<std::string_view>& args);
-    static ParseFunctionType parse_int_factory(const Aliases& names);
-    static ParseFunctionType parse_string_factory(const Aliases& names);
+    // Counters since construction or the last reset_stats, all zeros unless built with CPPLINE_PARSER_STATS=1
+    ParserStats get_stats() const;
+    void reset_stats();
+    // Logs get_stats().to_string(), does nothing in builds without CPPLINE_PARSER_STATS
+    void log_stats(LogLevel level = LogLevel::Info) const;
 
-    std::string m_description;
-    std::vector<Option> m_options;
-    std::unordered_map<std::string, size_t> m_option_map; // Maps option names to indices in m_options
-    std::vector<Option> m_positional_options;
+private:
+    ExpectedVoid parse_arguments(std::span<const std::string_view> arguments);
+    Expected<size_t> parse_positional(std::span<const std::string_view> arguments);
+    ExpectedVoid parse_non_positional(std::span<const std::string_view> arguments);
+
+    // Exactly one of builtin_parse_function and parse_function is set
+    ExpectedVoid try_add_value_option(std::span<const std::string> names,
+                                      std::string_view help,
+                                      BuiltinParseFunction builtin_parse_function,
+                                      ParseFunctionType&& parse_function,
+                                      size_t argument_count,
+                                      Value&& default_value);
+
+    ExpectedVoid try_add_positional_value_option(std::string_view help,
+                                                 BuiltinParseFunction builtin_parse_function,
+                                                 ParseFunctionType&& parse_function,
+                                                 size_t argument_count,
+                                                 Value&& default_value);
+
+    std::optional<size_t> find_option(std::string_view name) const;
+    Expected<Value> parse_value(const Option& option, std::span<const std::string_view> args);
+
+    template <typename T, typename ContextFactory>
+    static Expected<T> read_value(const Option& option, ContextFactory&& make_context);
+
+    static std::string join_names(std::span<const std::string> names);
+
+    static Expected<Value> parse_bool(std::span<const std::string_view> args);
+    template <NumberType T>
+    static Expected<Value> parse_numeric(std::span<const std::string_view> args);
+    static Expected<Value> parse_string(std::span<const std::string_view> args);
+
+#if CPPLINE_PARSER_STATS
+    // Wraps the resource passed to the constructor. Heap allocated, so the containers keep a valid resource
+    // when the Parser is moved.
+    std::unique_ptr<CountingResource> m_counting_resource;
+    ParserStats m_stats;
+#endif
+    std::pmr::memory_resource* m_resource;
+    std::pmr::string m_description;
+    std::pmr::vector<Option> m_options;
+    OptionMap m_option_map; // Maps option names to indices in m_options
+    OptionTable m_option_table; // Frozen copy of m_option_map used for lookups once registration is done
+    bool m_frozen = false;
+    bool m_freeze_attempted = false; // Set by freeze even if it failed, so parse does not retry the seed search
+    std::pmr::vector<Option> m_positional_options;
 };
 
 template <typename... Args>
 void Parser::add_option(Args&&... args)
 {
-    auto result = try_add_option(std::forward<Args>(args)...);
-    throw_on_error(result);
+    throw_on_error(try_add_option(std::forward<Args>(args)...));
 }
 
 template <typename... Args>
 void Parser::add_bool(Args&&... args)
 {
-    auto result = try_add_bool(std::forward<Args>(args)...);
-    throw_on_error(result);
+    throw_on_error(try_add_bool(std::forward<Args>(args)...));
 }
 
 template <typename... Args>
 void Parser::add_int(Args&&... args)
 {
-    auto result = try_add_int(std::forward<Args>(args)...);
-    throw_on_error(result);
+    throw_on_error(try_add_int(std::forward<Args>(args)...));
+}
+
+template <typename... Args>
+void Parser::add_int64(Args&&... args)
+{
+    throw_on_error(try_add_int64(std::forward<Args>(args)...));
+}
+
+template <typename... Args>
+void Parser::add_uint64(Args&&... args)
+{
+    throw_on_error(try_add_uint64(std::forward<Args>(args)...));
+}
+
+template <typename... Args>
+void Parser::add_double(Args&&... args)
+{
+    throw_on_error(try_add_double(std::forward<Args>(args)...));
 }
 
 template <typename... Args>
 void Parser::add_string(Args&&... args)
 {
-    auto result = try_add_string(std::forward<Args>(args)...);
-    throw_on_error(result);
+    throw_on_error(try_add_string(std::forward<Args>(args)...));
 }
 
 template <typename T>
-Expected<T> Parser::try_get(const std::string& name) const
+Expected<T> Parser::try_get(const std::string_view name) const
 {
-    if (m_option_map.contains(name)) {
-        const auto& option = m_options.at(m_option_map.at(name));
-        if (!option.value.has_value()) {
-            return make_unexpected(Status::OptionNotSet, Context{ Param::OptionName, name });
-        }
-        try {
-            return std::any_cast<T>(option.value);
-        }
-        catch (const std::bad_any_cast&) {
-            return make_unexpected(Status::InvalidValue, Context{ Param::OptionName, name });
-        }
+    auto make_context = [name] { return Context{ Param::OptionName, name }; };
+
+    const auto option_index = find_option(name);
+    if (!option_index.has_value()) {
+        return make_unexpected(Status::OptionNotFound, make_context());
     }
-    return make_unexpected(Status::OptionNotFound, Context{ Param::OptionName, name });
+
+    return read_value<T>(m_options[option_index.value()], make_context);
 }
 
 template <typename T>
-T Parser::get(const std::string& name) const
+T Parser::get(const std::string_view name) const
 {
-    auto result = try_get<T>(name);
-    throw_on_error(result);
-    return result.value();
+    return throw_on_error(try_get<T>(name));
 }
 
 template <typename T>
 Expected<T> Parser::try_get_positional(const size_t index) const
 {
+    auto make_context = [index] { return Context{ Param::Index, std::to_string(index) }; };
+
     if (index >= m_positional_options.size()) {
-        return make_unexpected(Status::IndexOutOfRange, Context{ Param::Index, std::to_string(index) });
+        return make_unexpected(Status::IndexOutOfRange, make_context());
     }
-    const auto& option = m_positional_options[index];
+
+    return read_value<T>(m_positional_options[index], make_context);
+}
+
+// Both the unset and the type mismatch cases are plain branches, nothing is thrown on the way to the caller
+template <typename T, typename ContextFactory>
+Expected<T> Parser::read_value(const Option& option, ContextFactory&& make_context)
+{
     if (!option.value.has_value()) {
-        return make_unexpected(Status::OptionNotSet, Context{ Param::Index, std::to_string(index) });
+        return make_unexpected(Status::OptionNotSet, make_context());
     }
-    try {
-        return std::any_cast<T>(option.value);
-    }
-    catch (const std::bad_any_cast&) {
-        return make_unexpected(Status::InvalidValue, Context{ Param::Index, std::to_string(index) });
+
+    const T* value = option.value.template get_if<T>();
+    if (value == nullptr) {
+        return make_unexpected(Status::InvalidValue, make_context());
     }
+    return *value;
 }
 
 template <typename T>
 T Parser::get_positional(const size_t index) const
 {
-    auto result = try_get_positional<T>(index);
-    throw_on_error(result);
-    return result.value();
+    return throw_on_error(try_get_positional<T>(index));
+}
+
+
+// Compile-time string usable as a template argument, e.g. StaticOption<int, "--count", "-c">
+export template <size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&str)[N])
+    {
+        std::copy_n(str, N, data);
+    }
+
+    constexpr std::string_view view() const
+    {
+        return { data, N - 1 };
+    }
+};
+
+// Conversion of option arguments for StaticParser, specialize to support more value types
+export template <typename T>
+struct StaticValue;
+
+template <>
+struct StaticValue<bool> {
+    static constexpr size_t argument_count = 0;
+
+    static Expected<bool> parse(std::span<const std::string_view>)
+    {
+        return true; // Presence implies true
+    }
+};
+
+template <NumberType T>
+struct StaticValue<T> {
+    static constexpr size_t argument_count = 1;
+
+    static Expected<T> parse(const std::span<const std::string_view> args)
+    {
+        return parse_number<T>(args[0]);
+    }
+};
+
+template <>
+struct StaticValue<std::string> {
+    static constexpr size_t argument_count = 1;
+
+    static Expected<std::string> parse(const std::span<const std::string_view> args)
+    {
+        return std::string(args[0]);
+    }
+};
+
+// A named option of a StaticParser, the first name is the primary one and the rest are aliases
+export template <typename T, FixedString Name, FixedString... Aliases>
+struct StaticOption {
+    using value_type = T;
+
+    static constexpr std::array<std::string_view, 1 + sizeof...(Aliases)> names{ Name.view(), Aliases.view()... };
+    static constexpr size_t argument_count = StaticValue<T>::argument_count;
+
+    static constexpr bool matches(const std::string_view token)
+    {
+        return std::ranges::find(names, token) != names.end();
+    }
+};
+
+template <typename... Opts>
+consteval bool static_names_are_unique()
+{
+    std::vector<std::string_view> all_names;
+    (all_names.insert(all_names.end(), Opts::names.begin(), Opts::names.end()), ...);
+    std::ranges::sort(all_names);
+    return std::ranges::adjacent_find(all_names) == all_names.end();
 }
 
+// Parser for option sets that are fixed at compile time.
+// Name lookup is a generated chain of compares against constant names and get<"--name">() is resolved
+// at compile time to a typed tuple element, so there is no std::function, std::any or hash map involved.
+export template <typename... Opts>
+class StaticParser final {
+public:
+    static constexpr size_t NOT_FOUND = sizeof...(Opts);
+
+    ExpectedVoid try_parse(const std::span<const std::string_view> arguments)
+    {
+        size_t cursor = 0; // Index of the next option name in arguments
+
+        while (cursor < arguments.size()) {
+            auto result = parse_token(arguments, cursor, std::index_sequence_for<Opts...>{});
+            if (!result.has_value()) {
+                return make_unexpected(std::move(result).error());
+            }
+        }
+
+        return success();
+    }
+
+    void parse(const std::span<const std::string_view> arguments)
+    {
+        throw_on_error(try_parse(arguments));
+    }
+
+    template <FixedString Name>
+    const auto& get() const
+    {
+        constexpr size_t index = find_index(Name.view());
+        static_assert(index != NOT_FOUND, "Unknown option name");
+        return std::get<index>(m_values);
+    }
+
+    template <FixedString Name>
+    bool is_set() const
+    {
+        constexpr size_t index = find_index(Name.view());
+        static_assert(index != NOT_FOUND, "Unknown option name");
+        return m_set[index];
+    }
+
+    static constexpr size_t find_index(const std::string_view name)
+    {
+        return find_index_impl(name, std::index_sequence_for<Opts...>{});
+    }
+
+private:
+    template <size_t Index>
+    using OptionAt = std::tuple_element_t<Index, std::tuple<Opts...>>;
+
+    static_assert(static_names_are_unique<Opts...>(), "StaticParser option names must be unique");
+
+    template <size_t... Is>
+    static constexpr size_t find_index_impl(const std::string_view name, std::index_sequence<Is...>)
+    {
+        size_t index = NOT_FOUND;
+        static_cast<void>(((OptionAt<Is>::matches(name) && (index = Is, true)) || ...));
+        return index;
+    }
+
+    template <size_t... Is>
+    ExpectedVoid parse_token(const std::span<const std::string_view> arguments, size_t& cursor, std::index_sequence<Is...>)
+    {
+        const std::string_view argument_name = arguments[cursor];
+
+        ExpectedVoid result;
+        const bool found = ((OptionAt<Is>::matches(argument_name) && (result = parse_option<Is>(arguments, cursor), true)) || ...);
+        if (!found) {
+            return make_unexpected(Status::OptionNotFound, Context{ Param::OptionName, argument_name });
+        }
+        return result;
+    }
+
+    template <size_t Index>
+    ExpectedVoid parse_option(const std::span<const std::string_view> arguments, size_t& cursor)
+    {
+        using Option = OptionAt<Index>;
+        const std::string_view argument_name = arguments[cursor];
+
+        if (m_set[Index]) {
+            return make_unexpected(Status::OptionAlreadySet, Context{ Param::OptionName, argument_name });
+        }
+
+        const size_t args_available = arguments.size() - cursor - 1;
+        if (args_available < Option::argument_count) {
+            const auto context = Context{ Param::OptionName, argument_name } <<
+                Context{ Param::ExpectedArgumentCount, std::to_string(Option::argument_count) } <<
+                Context{ Param::ReceivedArgumentCount, std::to_string(args_available) };
+            return make_unexpected(Status::NotEnoughArguments, context);
+        }
+
+        auto parse_result = StaticValue<typename Option::value_type>::parse(arguments.subspan(cursor + 1, Option::argument_count));
+        if (!parse_result.has_value()) {
+            return make_unexpected(Status::ParsingError, Context{ Param::OptionName, argument_name });
+        }
+
+        std::get<Index>(m_values) = std::move(parse_result.value());
+        m_set[Index] = true;
+        cursor += Option::argument_count + 1;
+
+        return success();
+    }
+
+    std::tuple<typename Opts::value_type...> m_values{};
+    std::bitset<sizeof...(Opts)> m_set;
+};
+
 } // namespace cppline
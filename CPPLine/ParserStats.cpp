@@ -0,0 +1,68 @@
+module CPPLine;
+
+import std;
+import ErrorHandling;
+
+using namespace cppline::errors;
+
+namespace cppline {
+
+std::uint64_t ParserStats::error_count(const Status status) const noexcept
+{
+    const auto* count = errors.find(status);
+    return count == nullptr ? 0 : *count;
+}
+
+std::string ParserStats::to_string() const
+{
+    std::string text = std::format(
+        "parse calls: {}, tokens: {}, lookups: {} ({} in the option map), parse functions: {} ({} custom), "
+        "allocations: {} ({} bytes), positional: {}, non-positional: {}, conversion: {}",
+        parse_calls, tokens_scanned, option_lookups, map_lookups, parse_function_calls, custom_parse_function_calls,
+        allocations, allocated_bytes, positional_time, non_positional_time, conversion_time);
+
+    for (const auto [status, count] : errors) {
+        text += std::format(", {}: {}", enum_name(status), count);
+    }
+    return text;
+}
+
+CountingResource::CountingResource(std::pmr::memory_resource* upstream) :
+    m_upstream(upstream)
+{
+}
+
+std::uint64_t CountingResource::allocations() const noexcept
+{
+    return m_allocations;
+}
+
+std::uint64_t CountingResource::allocated_bytes() const noexcept
+{
+    return m_allocated_bytes;
+}
+
+void CountingResource::reset() noexcept
+{
+    m_allocations = 0;
+    m_allocated_bytes = 0;
+}
+
+void* CountingResource::do_allocate(const size_t bytes, const size_t alignment)
+{
+    ++m_allocations;
+    m_allocated_bytes += bytes;
+    return m_upstream->allocate(bytes, alignment);
+}
+
+void CountingResource::do_deallocate(void* pointer, const size_t bytes, const size_t alignment)
+{
+    m_upstream->deallocate(pointer, bytes, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+} // namespace cppline
@@ -0,0 +1,74 @@
+export module CPPLine:ParserStats;
+
+import std;
+import ErrorHandling;
+
+using namespace cppline::errors;
+
+namespace cppline {
+
+// Counters a Parser collects while parsing. Only filled in by builds with CPPLINE_PARSER_STATS=1,
+// otherwise the instrumentation is compiled out and Parser::get_stats returns all zeros.
+export struct ParserStats {
+    std::uint64_t parse_calls = 0;
+    std::uint64_t tokens_scanned = 0; // Option names and arguments consumed
+    std::uint64_t option_lookups = 0;
+    std::uint64_t map_lookups = 0; // Lookups that used the option map because no frozen table was available
+    std::uint64_t parse_function_calls = 0; // Built-in and custom
+    std::uint64_t custom_parse_function_calls = 0;
+    std::uint64_t allocations = 0; // From the Parser's memory resource, values allocate on their own
+    std::uint64_t allocated_bytes = 0;
+    EnumIndexedMap<Status, std::uint64_t> errors; // Failed try_parse calls by Status
+
+    std::chrono::nanoseconds positional_time{};
+    std::chrono::nanoseconds non_positional_time{};
+    std::chrono::nanoseconds conversion_time{}; // Spent in parse functions, also counted in the phases above
+
+    std::uint64_t error_count(Status status) const noexcept;
+    std::string to_string() const;
+};
+
+// Forwards to an upstream resource and counts what is allocated through it
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream);
+
+    std::uint64_t allocations() const noexcept;
+    std::uint64_t allocated_bytes() const noexcept;
+    void reset() noexcept;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* m_upstream;
+    std::uint64_t m_allocations = 0;
+    std::uint64_t m_allocated_bytes = 0;
+};
+
+// Adds the time until it goes out of scope to a ParserStats duration
+class PhaseTimer final
+{
+public:
+    explicit PhaseTimer(std::chrono::nanoseconds& total) :
+        m_total(total),
+        m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~PhaseTimer()
+    {
+        m_total += std::chrono::steady_clock::now() - m_start;
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    std::chrono::nanoseconds& m_total;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace cppline
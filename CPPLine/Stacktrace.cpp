@@ -0,0 +1,47 @@
+module ErrorHandling;
+
+import std;
+
+namespace cppline::errors
+{
+std::mutex StacktraceFormatter::s_cache_mutex;
+std::unordered_map<std::stacktrace_entry, std::string> StacktraceFormatter::s_frame_cache;
+
+std::string StacktraceFormatter::format(const std::stacktrace& stacktrace)
+{
+    std::string stacktrace_string = "\n";
+    for (const auto& frame : stacktrace) {
+        stacktrace_string += format_frame(frame);
+    }
+    return stacktrace_string;
+}
+
+std::string StacktraceFormatter::format_frame(const std::stacktrace_entry& frame)
+{
+    {
+        std::scoped_lock lock(s_cache_mutex);
+        if (const auto cached = s_frame_cache.find(frame); cached != s_frame_cache.end()) {
+            return cached->second;
+        }
+    }
+
+    // Symbolize outside the lock, it is by far the slowest part
+    std::string frame_line = std::format("{}, file: {}, line: {}\n", frame.description(), frame.source_file(), frame.source_line());
+
+    std::scoped_lock lock(s_cache_mutex);
+    return s_frame_cache.try_emplace(frame, std::move(frame_line)).first->second;
+}
+
+size_t StacktraceFormatter::cache_size()
+{
+    std::scoped_lock lock(s_cache_mutex);
+    return s_frame_cache.size();
+}
+
+void StacktraceFormatter::clear_cache()
+{
+    std::scoped_lock lock(s_cache_mutex);
+    s_frame_cache.clear();
+}
+
+} // namespace cppline::errors
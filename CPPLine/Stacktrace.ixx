@@ -0,0 +1,33 @@
+export module ErrorHandling:Stacktrace;
+
+import std;
+
+namespace cppline::errors {
+
+// Renders captured stacktraces.
+// A std::stacktrace only holds frame addresses, symbol lookup happens here when a trace is rendered.
+// Resolved frames are cached by address, so repeated errors from the same site are symbolized once.
+export class StacktraceFormatter final
+{
+public:
+    static std::string format(const std::stacktrace& stacktrace);
+    static std::string format_frame(const std::stacktrace_entry& frame);
+
+    static size_t cache_size();
+    static void clear_cache();
+
+private:
+    static std::mutex s_cache_mutex;
+    static std::unordered_map<std::stacktrace_entry, std::string> s_frame_cache;
+
+public:
+    // Static class:
+    StacktraceFormatter() = delete;
+    ~StacktraceFormatter() = delete;
+    StacktraceFormatter(const StacktraceFormatter&) = delete;
+    StacktraceFormatter(StacktraceFormatter&&) = delete;
+    StacktraceFormatter& operator=(const StacktraceFormatter&) = delete;
+    StacktraceFormatter& operator=(StacktraceFormatter&&) = delete;
+};
+
+} // namespace cppline::errors
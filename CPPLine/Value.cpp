@@ -0,0 +1,27 @@
+module CPPLine;
+
+import std;
+
+namespace cppline {
+
+Value::Value(std::any value)
+{
+    if (!value.has_value()) {
+        return;
+    }
+
+    const bool unpacked = [this, &value]<typename... Types>(std::type_identity<std::tuple<Types...>>) {
+        return (try_unpack<Types>(value) || ...);
+    }(std::type_identity<BuiltinValueTypes>{});
+
+    if (!unpacked) {
+        m_storage.emplace<std::any>(std::move(value));
+    }
+}
+
+bool Value::has_value() const noexcept
+{
+    return !std::holds_alternative<std::monostate>(m_storage);
+}
+
+} // namespace cppline
@@ -0,0 +1,74 @@
+export module CPPLine:Value;
+
+import std;
+
+namespace cppline {
+
+export using ValueList = std::vector<std::string>;
+
+// Value kinds stored inline by Value, anything else is kept in a std::any
+using BuiltinValueTypes = std::tuple<bool, int, std::int64_t, std::uint64_t, double, std::string, std::string_view, ValueList>;
+
+template <typename T, typename List>
+struct is_one_of : std::false_type {};
+
+template <typename T, typename... Types>
+struct is_one_of<T, std::tuple<Types...>> : std::bool_constant<(std::same_as<T, Types> || ...)> {};
+
+template <typename T>
+concept BuiltinValue = is_one_of<T, BuiltinValueTypes>::value;
+
+// Parsed or default value of an option.
+// Built-in kinds live in a tagged union so a type check is a tag compare,
+// std::any is only used for values produced by custom parse functions.
+class Value final
+{
+public:
+    Value() = default;
+
+    template <BuiltinValue T>
+    Value(T value) :
+        m_storage(std::in_place_type<T>, std::move(value))
+    {
+    }
+
+    // Unpacks built-in kinds held by the any, so they are stored and retrieved like built-in values
+    Value(std::any value);
+
+    bool has_value() const noexcept;
+
+    // Returns nullptr if the stored value is not a T, never throws
+    template <typename T>
+    const T* get_if() const noexcept;
+
+private:
+    template <typename T>
+    bool try_unpack(std::any& value);
+
+    using Storage = std::variant<std::monostate, bool, int, std::int64_t, std::uint64_t, double, std::string, std::string_view, ValueList, std::any>;
+    Storage m_storage;
+};
+
+template <typename T>
+const T* Value::get_if() const noexcept
+{
+    if constexpr (BuiltinValue<T>) {
+        return std::get_if<T>(&m_storage);
+    }
+    else {
+        const auto* any_value = std::get_if<std::any>(&m_storage);
+        return any_value == nullptr ? nullptr : std::any_cast<T>(any_value);
+    }
+}
+
+template <typename T>
+bool Value::try_unpack(std::any& value)
+{
+    if (auto* builtin_value = std::any_cast<T>(&value)) {
+        m_storage.emplace<T>(std::move(*builtin_value));
+        return true;
+    }
+    return false;
+}
+
+} // namespace cppline
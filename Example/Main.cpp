@@ -22,7 +22,7 @@ int main(int argc, char* argv[])
 
     // Custom parser for space delimited key value pairs, no default value
     parser.add_option("--keyvalue", "Set a key-value pair",
-                      [](const std::vector<std::string_view>& args) -> std::any {
+                      [](std::span<const std::string_view> args) -> std::any {
                           if (args.size() < 2) {
                               throw Exception(Status::MissingArgument, Context{} << Message::ExpectedKeyAndValue); // Note logging of enum value.
                           }
@@ -0,0 +1,37 @@
+// main.cpp
+// Turns log files written with LogEncoding::Binary back into the text encoding:
+//   CPPLineLogDecoder [<rotated log>...] <binary log>
+// Rotated files of a MemoryMappedFileSink are given oldest first. They are decoded as one stream, since a
+// record longer than a whole file is split over several, and the zero tail of a file that was not closed ends it.
+import std;
+import ErrorHandling;
+
+using namespace cppline::errors;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: CPPLineLogDecoder <binary log>...\n";
+        return 1;
+    }
+
+    std::string input;
+    for (int index = 1; index < argc; ++index) {
+        std::ifstream file(argv[index], std::ios::binary);
+        if (!file) {
+            Logger::log("Cannot open log file", Context{ Param::FilePath, argv[index] });
+            return 1;
+        }
+        input.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    std::string output;
+    const auto result = Logger::decode_binary(input, output);
+    std::cout << output;
+    if (!result.has_value()) {
+        Logger::log("Cannot decode the log", result.error());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+# Optimization settings shared by every target, selected by the presets in CMakePresets.json.
+#
+# CMAKE_INTERPROCEDURAL_OPTIMIZATION=ON   link time optimization
+# CPPLINE_PGO=GENERATE                    instrumented build, running it writes profiles to CPPLINE_PGO_DIR
+# CPPLINE_PGO=USE                         optimized with the profiles in CPPLINE_PGO_DIR
+#                                         (Clang: merge them into default.profdata with llvm-profdata first)
+
+set(CPPLINE_PGO "OFF" CACHE STRING "Profile guided optimization: OFF, GENERATE or USE")
+set_property(CACHE CPPLINE_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(CPPLINE_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profiles" CACHE PATH "Profiles written by GENERATE and read by USE")
+
+if(CMAKE_INTERPROCEDURAL_OPTIMIZATION)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT ipo_supported OUTPUT ipo_output LANGUAGES CXX)
+    if(NOT ipo_supported)
+        message(FATAL_ERROR "Link time optimization is not supported: ${ipo_output}")
+    endif()
+endif()
+
+if(CPPLINE_PGO STREQUAL "OFF")
+    return()
+endif()
+
+if(MSVC)
+    message(FATAL_ERROR "CPPLINE_PGO supports GCC and Clang, use the Visual Studio PGO tools with MSVC")
+endif()
+
+if(CPPLINE_PGO STREQUAL "GENERATE")
+    file(MAKE_DIRECTORY "${CPPLINE_PGO_DIR}")
+    set(pgo_options "-fprofile-generate=${CPPLINE_PGO_DIR}")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        list(APPEND pgo_options -fprofile-update=atomic) # The async logger counts from several threads
+    endif()
+    add_compile_options(${pgo_options})
+    add_link_options(${pgo_options})
+elseif(CPPLINE_PGO STREQUAL "USE")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        add_compile_options("-fprofile-use=${CPPLINE_PGO_DIR}" -fprofile-partial-training -Wno-missing-profile)
+    else()
+        add_compile_options("-fprofile-use=${CPPLINE_PGO_DIR}/default.profdata" -Wno-profile-instr-unprofiled)
+    endif()
+else()
+    message(FATAL_ERROR "CPPLINE_PGO must be OFF, GENERATE or USE, not ${CPPLINE_PGO}")
+endif()
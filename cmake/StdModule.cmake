@@ -0,0 +1,66 @@
+# Every source uses `import std;`, so the std module is built here as the cppline_std target,
+# from the module source the standard library ships with:
+#   libstdc++ (GCC 15+)   bits/std.cc, found through libstdc++.modules.json
+#   libc++ (Clang 19+)    std.cppm, found through libc++.modules.json
+#   MSVC (17.10+)         modules/std.ixx in the toolset directory
+# Set CPPLINE_STD_MODULE_SOURCE to use another one.
+
+function(cppline_find_std_module_source result)
+    if(MSVC)
+        set(${result} "$ENV{VCToolsInstallDir}modules/std.ixx" PARENT_SCOPE)
+        return()
+    endif()
+
+    foreach(manifest_name IN ITEMS libstdc++.modules.json libc++.modules.json)
+        execute_process(COMMAND "${CMAKE_CXX_COMPILER}" -print-file-name=${manifest_name}
+                        OUTPUT_VARIABLE manifest OUTPUT_STRIP_TRAILING_WHITESPACE)
+        if(NOT IS_ABSOLUTE "${manifest}" OR NOT EXISTS "${manifest}")
+            continue()
+        endif()
+
+        file(READ "${manifest}" manifest_json)
+        string(JSON module_count LENGTH "${manifest_json}" modules)
+        math(EXPR last_module "${module_count} - 1")
+        foreach(index RANGE ${last_module})
+            string(JSON logical_name GET "${manifest_json}" modules ${index} logical-name)
+            if(logical_name STREQUAL "std")
+                string(JSON source GET "${manifest_json}" modules ${index} source-path)
+                cmake_path(GET manifest PARENT_PATH manifest_directory)
+                cmake_path(ABSOLUTE_PATH source BASE_DIRECTORY "${manifest_directory}" NORMALIZE)
+                set(${result} "${source}" PARENT_SCOPE)
+                return()
+            endif()
+        endforeach()
+    endforeach()
+
+    set(${result} "" PARENT_SCOPE)
+endfunction()
+
+if(NOT CPPLINE_STD_MODULE_SOURCE)
+    cppline_find_std_module_source(std_module_source)
+    set(CPPLINE_STD_MODULE_SOURCE "${std_module_source}" CACHE FILEPATH "Source of the std module")
+endif()
+
+if(NOT EXISTS "${CPPLINE_STD_MODULE_SOURCE}")
+    message(FATAL_ERROR "No std module source found for ${CMAKE_CXX_COMPILER_ID} ${CMAKE_CXX_COMPILER_VERSION}. "
+                        "Use GCC 15+, Clang 19+ with libc++ or MSVC 17.10+, or set CPPLINE_STD_MODULE_SOURCE.")
+endif()
+message(STATUS "std module source: ${CPPLINE_STD_MODULE_SOURCE}")
+
+cmake_path(GET CPPLINE_STD_MODULE_SOURCE PARENT_PATH std_module_directory)
+add_library(cppline_std STATIC)
+target_sources(cppline_std
+    PUBLIC
+        FILE_SET CXX_MODULES
+        BASE_DIRS "${std_module_directory}"
+        FILES "${CPPLINE_STD_MODULE_SOURCE}"
+)
+set_source_files_properties("${CPPLINE_STD_MODULE_SOURCE}" PROPERTIES LANGUAGE CXX)
+target_compile_features(cppline_std PUBLIC cxx_std_23)
+
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    # std::stacktrace is not part of libstdc++ itself yet
+    target_link_libraries(cppline_std PUBLIC stdc++exp)
+elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    target_compile_options(cppline_std PRIVATE -Wno-reserved-module-identifier -Wno-reserved-identifier)
+endif()